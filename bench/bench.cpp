@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "bench.h"
+
+#include <vulxels/log.h>
+#include <vulxels/version.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace Vulxels;
+using namespace Vulxels::Bench;
+
+static f64 percentile(const std::vector<f64>& sorted, const f64 p) {
+	// Linear interpolation between the closest ranks
+	const f64 rank = p * static_cast<f64>(sorted.size() - 1);
+	const usize lower = static_cast<usize>(rank);
+	const usize upper = std::min(lower + 1, sorted.size() - 1);
+	return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<f64>(lower));
+}
+
+Summary Bench::summarize(std::vector<f64> samples) {
+	Summary summary;
+	if (samples.empty()) {
+		return summary;
+	}
+	std::ranges::sort(samples);
+
+	summary.count = samples.size();
+	summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<f64>(samples.size());
+	f64 variance = 0.0;
+	for (const f64 sample : samples) {
+		variance += (sample - summary.mean) * (sample - summary.mean);
+	}
+	summary.stddev = samples.size() > 1 ? std::sqrt(variance / static_cast<f64>(samples.size() - 1)) : 0.0;
+	summary.min = samples.front();
+	summary.p50 = percentile(samples, 0.50);
+	summary.p90 = percentile(samples, 0.90);
+	summary.p95 = percentile(samples, 0.95);
+	summary.p99 = percentile(samples, 0.99);
+	summary.max = samples.back();
+	return summary;
+}
+
+Estimate Bench::estimate(const Result& result) {
+	Estimate estimate;
+	if (result.runs.empty()) {
+		return estimate;
+	}
+	std::vector<f64> runs = result.runs;
+	std::ranges::sort(runs);
+	estimate.median = percentile(runs, 0.5);
+
+	if (runs.size() >= 3) {
+		// Median absolute deviation, scaled to match a standard deviation
+		std::vector<f64> deviations;
+		for (const f64 run : runs) {
+			deviations.push_back(std::abs(run - estimate.median));
+		}
+		std::ranges::sort(deviations);
+		estimate.spread = 1.4826 * percentile(deviations, 0.5);
+	} else {
+		// Too few runs to say anything, use the standard error of a single run's median
+		const auto summary = summarize(result.samples);
+		if (summary.count > 0) {
+			estimate.spread = 1.2533 * summary.stddev / std::sqrt(static_cast<f64>(summary.count));
+		}
+	}
+	return estimate;
+}
+
+GFX::Renderer& Context::renderer() {
+	if (!m_renderer) {
+		GFX::RendererConfig config;
+		config.present_mode = m_options.present_mode;
+		config.device = m_options.device;
+		if (m_options.windowed) {
+			m_window = std::make_unique<GFX::Window>(
+				"Vulxels Benchmark",
+				static_cast<int>(m_options.extent.width),
+				static_cast<int>(m_options.extent.height)
+			);
+			m_renderer = std::make_unique<GFX::Renderer>(*m_window, config);
+		} else {
+			m_renderer = std::make_unique<GFX::Renderer>(m_options.extent, config);
+		}
+	}
+	return *m_renderer;
+}
+
+Result& Context::result(const std::string& name, const std::string& unit) {
+	for (auto& result : m_results) {
+		if (result.name == name) {
+			return result;
+		}
+	}
+	m_results.push_back({name, unit, {}, {}, 0});
+	return m_results.back();
+}
+
+void Context::end_run() {
+	for (auto& result : m_results) {
+		if (result.run_start == result.samples.size()) {
+			continue;
+		}
+		const auto begin = result.samples.begin() + static_cast<isize>(result.run_start);
+		result.runs.push_back(summarize(std::vector<f64>(begin, result.samples.end())).p50);
+		result.run_start = result.samples.size();
+	}
+}
+
+std::string Bench::to_json(Context& context) {
+	const auto& options = context.options();
+
+	std::string device = "none";
+	if (context.has_renderer()) {
+		device = context.renderer().device().physical_device().getProperties().deviceName.data();
+	}
+
+#if defined(__clang__)
+	const std::string compiler = fmt::format("clang {}.{}", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+	const std::string compiler = fmt::format("gcc {}.{}", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+	const std::string compiler = fmt::format("msvc {}", _MSC_VER);
+#else
+	const std::string compiler = "unknown";
+#endif
+#ifdef NDEBUG
+	const char* build = "release";
+#else
+	const char* build = "debug";
+#endif
+
+	std::string json = "{\n";
+	json += fmt::format(
+		"  \"version\": \"{}.{}.{}\",\n  \"compiler\": \"{}\",\n  \"build\": \"{}\",\n  \"device\": \"{}\",\n",
+		VX_VERSION_MAJOR,
+		VX_VERSION_MINOR,
+		VX_VERSION_PATCH,
+		compiler,
+		build,
+		device
+	);
+	json += fmt::format(
+		"  \"options\": {{\"width\": {}, \"height\": {}, \"frames\": {}, \"iterations\": {}, \"present_mode\": \"{}\", "
+		"\"seed\": {}, \"windowed\": {}, \"repeat\": {}}},\n",
+		options.extent.width,
+		options.extent.height,
+		options.frames,
+		options.iterations,
+		vk::to_string(options.present_mode),
+		options.seed,
+		options.windowed,
+		options.repeat
+	);
+
+	json += "  \"results\": [";
+	const char* separator = "\n";
+	for (const auto& result : context.results()) {
+		const auto s = summarize(result.samples);
+		const auto e = estimate(result);
+		json += separator;
+		json += fmt::format(
+			"    {{\"name\": \"{}\", \"unit\": \"{}\", \"runs\": {}, \"median\": {:.6f}, \"spread\": {:.6f}, "
+			"\"count\": {}, \"mean\": {:.6f}, \"stddev\": {:.6f}, \"min\": {:.6f}, \"p50\": {:.6f}, \"p90\": {:.6f}, "
+			"\"p95\": {:.6f}, \"p99\": {:.6f}, \"max\": {:.6f}}}",
+			result.name,
+			result.unit,
+			result.runs.size(),
+			e.median,
+			e.spread,
+			s.count,
+			s.mean,
+			s.stddev,
+			s.min,
+			s.p50,
+			s.p90,
+			s.p95,
+			s.p99,
+			s.max
+		);
+		separator = ",\n";
+	}
+	json += "\n  ]\n}\n";
+	return json;
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/renderer.h>
+#include <vulxels/gfx/window.h>
+#include <vulxels/types.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vulxels::Bench {
+	struct Options {
+		vk::Extent2D extent {1280, 720};
+		u32 frames = 600; // per macro benchmark
+		u32 iterations = 50; // per micro benchmark
+		u32 warmup = 5;
+		vk::PresentModeKHR present_mode = vk::PresentModeKHR::eImmediate;
+		u64 seed = 1;
+		bool windowed = false;
+		std::string device; // index or part of the name, the best scoring device when empty
+		std::string filter; // only benchmarks whose name contains this run
+		std::string output; // JSON goes to stdout when empty
+		u32 repeat = 1; // whole suite runs, metrics use the median across them
+		std::string compare; // baseline JSON to check the results against
+		f64 tolerance = 0.05; // smallest relative slowdown counted as a regression
+		bool allow_missing = false; // baseline metrics the run didn't produce don't fail the comparison
+	};
+
+	struct Summary {
+		usize count = 0;
+		f64 mean = 0.0;
+		f64 stddev = 0.0;
+		f64 min = 0.0;
+		f64 p50 = 0.0;
+		f64 p90 = 0.0;
+		f64 p95 = 0.0;
+		f64 p99 = 0.0;
+		f64 max = 0.0;
+	};
+
+	Summary summarize(std::vector<f64> samples);
+
+	struct Result {
+		std::string name;
+		std::string unit;
+		std::vector<f64> samples; // every run pooled
+		std::vector<f64> runs; // median of each run
+		usize run_start = 0;
+	};
+
+	// Median across runs and a robust estimate of how much it moves between them
+	struct Estimate {
+		f64 median = 0.0;
+		f64 spread = 0.0;
+	};
+
+	Estimate estimate(const Result& result);
+
+	class Context {
+	  public:
+		explicit Context(const Options& options) : m_options(options) {}
+
+		const Options& options() const {
+			return m_options;
+		}
+
+		// Created on first use, so benchmarks that don't need a GPU don't pay for one
+		GFX::Renderer& renderer();
+
+		bool has_renderer() const {
+			return m_renderer != nullptr;
+		}
+
+		Result& result(const std::string& name, const std::string& unit = "ms");
+
+		const std::vector<Result>& results() const {
+			return m_results;
+		}
+
+		// Closes the current run of the suite, recording each metric's median for it
+		void end_run();
+
+		// Runs `func` for the warmup iterations and then records the time taken by
+		// each of the measured ones in milliseconds
+		template<typename F>
+		void measure(const std::string& name, F&& func) {
+			for (u32 i = 0; i < m_options.warmup; i++) {
+				func();
+			}
+			auto& samples = result(name).samples;
+			for (u32 i = 0; i < m_options.iterations; i++) {
+				const auto start = std::chrono::steady_clock::now();
+				func();
+				const auto end = std::chrono::steady_clock::now();
+				samples.push_back(std::chrono::duration<f64, std::milli>(end - start).count());
+			}
+		}
+
+	  private:
+		Options m_options;
+		std::unique_ptr<GFX::Window> m_window;
+		std::unique_ptr<GFX::Renderer> m_renderer;
+		std::vector<Result> m_results;
+	};
+
+	struct Benchmark {
+		std::string name;
+		std::function<void(Context&)> run;
+	};
+
+	void add_gfx_benchmarks(std::vector<Benchmark>& benchmarks);
+	void add_flythrough_benchmarks(std::vector<Benchmark>& benchmarks);
+	void add_world_benchmarks(std::vector<Benchmark>& benchmarks);
+
+	std::string to_json(Context& context);
+
+	// Prints a per-metric report against the baseline JSON and returns false if
+	// any metric regressed by more than the tolerance and the measured noise
+	bool compare(Context& context, const std::string& baseline);
+} // namespace Vulxels::Bench
@@ -0,0 +1,335 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "bench.h"
+
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace Vulxels;
+using namespace Vulxels::Bench;
+
+namespace {
+	// Just enough JSON to read back what to_json() writes
+	struct Json {
+		using Array = std::vector<Json>;
+		using Object = std::vector<std::pair<std::string, Json>>;
+
+		std::variant<std::nullptr_t, bool, f64, std::string, Array, Object> value;
+
+		const Json* find(const std::string_view key) const {
+			if (const auto* object = std::get_if<Object>(&value)) {
+				for (const auto& [name, member] : *object) {
+					if (name == key) {
+						return &member;
+					}
+				}
+			}
+			return nullptr;
+		}
+
+		f64 number(const std::string_view key, const f64 fallback = 0.0) const {
+			const auto* member = find(key);
+			const auto* number = member ? std::get_if<f64>(&member->value) : nullptr;
+			return number ? *number : fallback;
+		}
+
+		std::string string(const std::string_view key) const {
+			const auto* member = find(key);
+			const auto* string = member ? std::get_if<std::string>(&member->value) : nullptr;
+			return string ? *string : std::string();
+		}
+	};
+
+	class JsonReader {
+	  public:
+		explicit JsonReader(const std::string_view text) : m_text(text) {}
+
+		Json parse() {
+			auto value = parse_value();
+			skip_whitespace();
+			if (m_pos != m_text.size()) {
+				error("trailing characters");
+			}
+			return value;
+		}
+
+	  private:
+		std::string_view m_text;
+		usize m_pos = 0;
+
+		[[noreturn]] void error(const std::string_view what) const {
+			throw std::runtime_error(fmt::format("Invalid JSON at offset {}: {}", m_pos, what));
+		}
+
+		void skip_whitespace() {
+			while (m_pos < m_text.size() && std::string_view(" \t\r\n").find(m_text[m_pos]) != std::string_view::npos) {
+				m_pos++;
+			}
+		}
+
+		bool consume(const char c) {
+			skip_whitespace();
+			if (m_pos < m_text.size() && m_text[m_pos] == c) {
+				m_pos++;
+				return true;
+			}
+			return false;
+		}
+
+		void expect(const char c) {
+			if (!consume(c)) {
+				error(fmt::format("expected '{}'", c));
+			}
+		}
+
+		bool consume_word(const std::string_view word) {
+			if (m_text.substr(m_pos, word.size()) == word) {
+				m_pos += word.size();
+				return true;
+			}
+			return false;
+		}
+
+		Json parse_value() {
+			skip_whitespace();
+			if (m_pos >= m_text.size()) {
+				error("unexpected end");
+			}
+
+			const char c = m_text[m_pos];
+			if (c == '{') {
+				return parse_object();
+			}
+			if (c == '[') {
+				return parse_array();
+			}
+			if (c == '"') {
+				return {parse_string()};
+			}
+			if (consume_word("true")) {
+				return {true};
+			}
+			if (consume_word("false")) {
+				return {false};
+			}
+			if (consume_word("null")) {
+				return {nullptr};
+			}
+			return {parse_number()};
+		}
+
+		Json parse_object() {
+			expect('{');
+			Json::Object object;
+			if (consume('}')) {
+				return {std::move(object)};
+			}
+			do {
+				skip_whitespace();
+				auto key = parse_string();
+				expect(':');
+				object.emplace_back(std::move(key), parse_value());
+			} while (consume(','));
+			expect('}');
+			return {std::move(object)};
+		}
+
+		Json parse_array() {
+			expect('[');
+			Json::Array array;
+			if (consume(']')) {
+				return {std::move(array)};
+			}
+			do {
+				array.push_back(parse_value());
+			} while (consume(','));
+			expect(']');
+			return {std::move(array)};
+		}
+
+		std::string parse_string() {
+			if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+				error("expected string");
+			}
+			m_pos++;
+
+			std::string string;
+			while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+				char c = m_text[m_pos++];
+				if (c == '\\' && m_pos < m_text.size()) {
+					c = m_text[m_pos++];
+					switch (c) {
+						case 'n':
+							c = '\n';
+							break;
+						case 't':
+							c = '\t';
+							break;
+						case 'u':
+							// Nothing we write needs it, keep a placeholder
+							m_pos = std::min(m_pos + 4, m_text.size());
+							c = '?';
+							break;
+						default:
+							break;
+					}
+				}
+				string += c;
+			}
+			if (m_pos >= m_text.size()) {
+				error("unterminated string");
+			}
+			m_pos++;
+			return string;
+		}
+
+		f64 parse_number() {
+			static constexpr std::string_view NUMBER_CHARS = "+-.eE0123456789";
+			const usize start = m_pos;
+			while (m_pos < m_text.size() && NUMBER_CHARS.find(m_text[m_pos]) != std::string_view::npos) {
+				m_pos++;
+			}
+			if (start == m_pos) {
+				error("unexpected character");
+			}
+			return std::stod(std::string(m_text.substr(start, m_pos - start)));
+		}
+	};
+
+	// A slowdown only counts once it clears both the tolerance and a few
+	// multiples of the noise either side measured
+	constexpr f64 NOISE_SIGMAS = 3.0;
+} // namespace
+
+bool Bench::compare(Context& context, const std::string& baseline) {
+	std::ifstream file(baseline);
+	if (!file) {
+		throw std::runtime_error("Failed to open baseline, record one on this device first: " + baseline);
+	}
+	std::stringstream stream;
+	stream << file.rdbuf();
+	const auto json = JsonReader(stream.str()).parse();
+
+	struct Metric {
+		std::string unit;
+		f64 median;
+		f64 spread;
+	};
+	std::unordered_map<std::string, Metric> expected;
+	if (const auto* results = json.find("results")) {
+		if (const auto* array = std::get_if<Json::Array>(&results->value)) {
+			for (const auto& result : *array) {
+				// Older files without repeats only have the plain percentiles
+				expected[result.string("name")] = {
+					result.string("unit"),
+					result.number("median", result.number("p50")),
+					result.number("spread")
+				};
+			}
+		}
+	}
+
+	const auto device = json.string("device");
+	if (context.has_renderer()) {
+		const std::string current = context.renderer().device().physical_device().getProperties().deviceName.data();
+		if (!device.empty() && device != current) {
+			VX_WARN("Baseline was recorded on \"{}\" but running on \"{}\"", device, current);
+		}
+	}
+
+	const f64 tolerance = context.options().tolerance;
+	usize regressions = 0;
+	std::fprintf(stderr, "%-36s %14s %14s %9s %9s  %s\n", "metric", "baseline", "current", "delta", "limit", "status");
+	for (const auto& result : context.results()) {
+		const auto current = estimate(result);
+		const auto it = expected.find(result.name);
+		if (it == expected.end()) {
+			std::fprintf(
+				stderr,
+				"%-36s %14s %11.4f %-2s %9s %9s  new\n",
+				result.name.c_str(),
+				"-",
+				current.median,
+				result.unit.c_str(),
+				"-",
+				"-"
+			);
+			continue;
+		}
+
+		const auto& base = it->second;
+		// Positive is a slowdown, rates count the other way to times
+		const f64 sign = result.unit.ends_with("/s") ? -1.0 : 1.0;
+		const f64 delta = base.median > 0.0 ? sign * (current.median - base.median) / base.median : 0.0;
+		const f64 noise = base.median > 0.0 ? NOISE_SIGMAS * std::max(base.spread, current.spread) / base.median : 0.0;
+		const f64 limit = std::max(tolerance, noise);
+
+		// Only getting slower fails
+		const char* status = "ok";
+		if (delta > limit) {
+			status = "REGRESSED";
+			regressions++;
+		} else if (delta < -limit) {
+			status = "improved";
+		}
+		std::fprintf(
+			stderr,
+			"%-36s %11.4f %-2s %11.4f %-2s %+8.1f%% %8.1f%%  %s\n",
+			result.name.c_str(),
+			base.median,
+			base.unit.c_str(),
+			current.median,
+			result.unit.c_str(),
+			delta * 100.0,
+			limit * 100.0,
+			status
+		);
+		expected.erase(it);
+	}
+	// A benchmark that crashed, was skipped or renamed would otherwise pass unnoticed
+	const bool allow_missing = context.options().allow_missing;
+	for (const auto& [name, metric] : expected) {
+		std::fprintf(
+			stderr,
+			"%-36s %11.4f %-2s %14s %9s %9s  %s\n",
+			name.c_str(),
+			metric.median,
+			metric.unit.c_str(),
+			"-",
+			"-",
+			"-",
+			allow_missing ? "not run" : "MISSING"
+		);
+	}
+
+	bool passed = true;
+	if (regressions > 0) {
+		VX_ERROR("{} metric(s) regressed against \"{}\"", regressions, baseline);
+		passed = false;
+	}
+	if (!expected.empty() && !allow_missing) {
+		VX_ERROR("{} metric(s) in \"{}\" weren't produced, pass --allow-missing to ignore", expected.size(), baseline);
+		passed = false;
+	}
+	if (!passed) {
+		return false;
+	}
+	VX_LOG("No regressions against \"{}\"", baseline);
+	return true;
+}
@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "bench.h"
+
+#include <vulxels/gfx/chunk_renderer.h>
+#include <vulxels/gfx/render_graph.h>
+#include <vulxels/job_system.h>
+#include <vulxels/log.h>
+#include <vulxels/world/chunk_map.h>
+#include <vulxels/world/mesher.h>
+#include <vulxels/world/terrain.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace Vulxels;
+using namespace Vulxels::Bench;
+
+namespace {
+	constexpr vk::Format DEPTH_FORMAT = vk::Format::eD32Sfloat;
+
+	// 16×5×16 chunks, 512 blocks across and from the caves up through the peaks
+	constexpr glm::ivec3 TERRAIN_MIN {-8, -2, -8};
+	constexpr glm::ivec3 TERRAIN_MAX {8, 3, 8};
+
+	// Generated and meshed across the workers the same way the app loads its
+	// world, then uploaded once every chunk is done. None of it is measured.
+	void load_terrain(GFX::Renderer& renderer, GFX::ChunkRenderer& chunk_renderer, const u64 seed) {
+		VX_ZONE("load_terrain");
+		auto& jobs = renderer.jobs();
+		const World::TerrainGenerator generator(seed);
+
+		// Every chunk is in the map before any job starts, so it never rehashes under them
+		World::ChunkMap<World::Chunk> chunks;
+		std::vector<glm::ivec3> coords;
+		for (i32 y = TERRAIN_MIN.y; y < TERRAIN_MAX.y; y++) {
+			for (i32 z = TERRAIN_MIN.z; z < TERRAIN_MAX.z; z++) {
+				for (i32 x = TERRAIN_MIN.x; x < TERRAIN_MAX.x; x++) {
+					coords.emplace_back(x, y, z);
+					chunks.try_emplace({x, y, z});
+				}
+			}
+		}
+
+		JobSystem::Counter generated;
+		for (const auto coord : coords) {
+			jobs.run(
+				[&generator, chunk = chunks.find(coord), coord] { generator.generate(coord, *chunk); },
+				JobSystem::Priority::High,
+				&generated
+			);
+		}
+		jobs.wait(generated, JobSystem::Priority::High);
+
+		JobSystem::Counter meshed;
+		std::vector<std::vector<World::ChunkQuad>> meshes(coords.size());
+		const auto& lookup = std::as_const(chunks);
+		for (usize i = 0; i < coords.size(); i++) {
+			jobs.run(
+				[&meshes, i, chunk = lookup.find(coords[i]), neighbours = lookup.neighbours(coords[i])] {
+					thread_local auto mesher = std::make_unique<World::Mesher>();
+					mesher->mesh(*chunk, neighbours, meshes[i]);
+				},
+				JobSystem::Priority::High,
+				&meshed
+			);
+		}
+		jobs.wait(meshed, JobSystem::Priority::High);
+
+		for (usize i = 0; i < coords.size(); i++) {
+			chunk_renderer.upload(coords[i], meshes[i]);
+		}
+		const auto& stats = chunk_renderer.stats();
+		VX_LOG("Flythrough terrain: {} chunks, {} quads", stats.chunks, stats.quads);
+	}
+
+	// A closed loop around the middle of the terrain, looking slightly ahead
+	glm::mat4 camera(const World::TerrainGenerator& generator, const f32 t, const f32 aspect) {
+		const f32 radius = static_cast<f32>(TERRAIN_MAX.x * static_cast<i32>(World::Chunk::SIZE)) * 0.6f;
+		const auto point = [&](const f32 s) {
+			const f32 angle = s * glm::two_pi<f32>();
+			const f32 x = std::cos(angle) * radius;
+			const f32 z = std::sin(angle * 2.0f) * radius * 0.5f + std::sin(angle) * radius * 0.5f;
+			const auto ground = generator.height(static_cast<i32>(std::floor(x)), static_cast<i32>(std::floor(z)));
+			const f32 height = std::max(static_cast<f32>(ground), static_cast<f32>(World::TerrainGenerator::SEA_LEVEL));
+			return glm::vec3(x, height + 24.0f, z);
+		};
+
+		const auto eye = point(t);
+		const auto target = point(t + 0.02f) - glm::vec3(0.0f, 8.0f, 0.0f);
+		auto projection = glm::perspective(glm::radians(70.0f), aspect, 0.1f, 1000.0f);
+		projection[1][1] *= -1.0f;
+		return projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+} // namespace
+
+static void bench_flythrough(Context& context) {
+	const auto& options = context.options();
+	auto& renderer = context.renderer();
+
+	// The same graph, chunk renderer and shaders the app draws its world with
+	GFX::RenderGraph graph(renderer);
+	GFX::ChunkRenderer chunk_renderer(renderer, graph, renderer.swapchain().format().format, DEPTH_FORMAT);
+	load_terrain(renderer, chunk_renderer, options.seed);
+	if (!chunk_renderer.pipeline().wait()) {
+		throw std::runtime_error("Failed to compile the chunk pipeline");
+	}
+
+	const World::TerrainGenerator generator(options.seed);
+	auto& cpu = context.result("flythrough/frame_cpu");
+	auto& interval = context.result("flythrough/frame_interval");
+	auto& gpu = context.result("flythrough/frame_gpu");
+
+	using Clock = std::chrono::steady_clock;
+	auto& profiler = renderer.profiler();
+	u64 collected = profiler.frames_collected();
+	auto last_end = Clock::now();
+
+	const u32 total = options.warmup + options.frames;
+	for (u32 frame = 0; frame < total;) {
+		const auto start = Clock::now();
+		const auto cmd = renderer.begin_frame();
+		if (!cmd) {
+			continue; // Swapchain was recreated, try the same frame again
+		}
+		const bool measured = frame >= options.warmup;
+		if (measured && profiler.frames_collected() != collected && !profiler.timings().empty()) {
+			gpu.samples.push_back(profiler.timings().front().ms);
+		}
+		collected = profiler.frames_collected();
+
+		graph.reset();
+		const auto backbuffer = graph.import_backbuffer();
+		const auto depth = graph.create_image("Depth", {DEPTH_FORMAT});
+
+		const f32 t = static_cast<f32>(frame) / static_cast<f32>(total);
+		const auto view_proj = camera(generator, t, renderer.swapchain().aspect());
+		graph
+			.add_pass(
+				"Scene",
+				[&chunk_renderer, view_proj](const GFX::RenderGraph::PassContext& pass) {
+					chunk_renderer.draw(pass, view_proj);
+				}
+			)
+			.write_color(backbuffer, vk::ClearColorValue(0.5f, 0.7f, 0.9f, 1.0f))
+			.write_depth(depth, 1.0f)
+			.use_secondary_buffers();
+
+		graph.execute(*cmd);
+		renderer.end_frame(cmd);
+
+		const auto end = Clock::now();
+		if (measured) {
+			cpu.samples.push_back(std::chrono::duration<f64, std::milli>(end - start).count());
+			interval.samples.push_back(std::chrono::duration<f64, std::milli>(end - last_end).count());
+		}
+		last_end = end;
+		frame++;
+	}
+
+	renderer.device().wait_idle();
+}
+
+void Bench::add_flythrough_benchmarks(std::vector<Benchmark>& benchmarks) {
+	benchmarks.push_back({"flythrough", bench_flythrough});
+}
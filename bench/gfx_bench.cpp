@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "bench.h"
+
+#include <vulxels/gfx/buffer.h>
+#include <vulxels/gfx/descriptors.h>
+#include <vulxels/gfx/pipeline.h>
+#include <vulxels/gfx/staging.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+using namespace Vulxels;
+using namespace Vulxels::Bench;
+
+static std::shared_ptr<vk::raii::RenderPass> create_render_pass(GFX::Renderer& renderer) {
+	const auto color = vk::AttachmentDescription()
+						   .setFormat(renderer.swapchain().format().format)
+						   .setSamples(vk::SampleCountFlagBits::e1)
+						   .setLoadOp(vk::AttachmentLoadOp::eClear)
+						   .setStoreOp(vk::AttachmentStoreOp::eStore)
+						   .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+						   .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+						   .setInitialLayout(vk::ImageLayout::eUndefined)
+						   .setFinalLayout(renderer.swapchain().final_layout());
+	const auto reference = vk::AttachmentReference(0, vk::ImageLayout::eColorAttachmentOptimal);
+	const auto subpass =
+		vk::SubpassDescription().setPipelineBindPoint(vk::PipelineBindPoint::eGraphics).setColorAttachments(reference);
+	return std::make_shared<vk::raii::RenderPass>(
+		renderer.device().device(),
+		vk::RenderPassCreateInfo().setAttachments(color).setSubpasses(subpass)
+	);
+}
+
+static void bench_buffer_write(Context& context) {
+	auto& device = context.renderer().device();
+	auto& staging = device.staging();
+
+	static constexpr std::array<std::pair<vk::DeviceSize, const char*>, 4> sizes = {{
+		{4 * 1024, "4KiB"},
+		{64 * 1024, "64KiB"},
+		{1024 * 1024, "1MiB"},
+		{16 * 1024 * 1024, "16MiB"},
+	}};
+
+	std::mt19937_64 rng(context.options().seed);
+	for (const auto& [size, label] : sizes) {
+		std::vector<u8> data(size);
+		for (auto& byte : data) {
+			byte = static_cast<u8>(rng());
+		}
+
+		// Measured until the copy has landed, not just until it was queued
+		GFX::Buffer buffer(device, size, vk::BufferUsageFlagBits::eStorageBuffer);
+		context.measure(fmt::format("buffer_write/{}", label), [&] {
+			buffer.write(data.data(), size);
+			staging.timeline().wait(staging.flush());
+		});
+	}
+}
+
+static void bench_pipeline_create(Context& context) {
+	auto& renderer = context.renderer();
+	const auto vert = std::make_shared<GFX::Shader>(renderer.device(), "simple.vert.spv");
+	const auto frag = std::make_shared<GFX::Shader>(renderer.device(), "simple.frag.spv");
+	const auto render_pass = create_render_pass(renderer);
+
+	const auto builder = [&] {
+		auto builder = renderer.create_pipeline();
+		builder.use_default()
+			.add_shader_stage(vert, vk::ShaderStageFlagBits::eVertex)
+			.add_shader_stage(frag, vk::ShaderStageFlagBits::eFragment)
+			.add_vertex_binding_description(0, 20, vk::VertexInputRate::eVertex)
+			.add_vertex_attribute_description(0, 0, vk::Format::eR32G32Sfloat, 0)
+			.add_vertex_attribute_description(0, 1, vk::Format::eR32G32B32Sfloat, 8)
+			.set_render_pass(render_pass, {renderer.swapchain().format().format});
+		return builder;
+	};
+
+	// Backed by the device pipeline cache, so this is the warm path after the first build
+	context.measure("pipeline_create/build", [&] {
+		auto b = builder();
+		const auto pipeline = b.build();
+	});
+
+	auto b = builder();
+	renderer.pipelines().get(b);
+	context.measure("pipeline_create/library_hit", [&] {
+		auto lookup = builder();
+		const auto pipeline = renderer.pipelines().get(lookup);
+	});
+}
+
+static void bench_descriptor_alloc(Context& context) {
+	auto& device = context.renderer().device();
+
+	GFX::DescriptorLayout layout(device);
+	layout.add_binding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex);
+	layout.add_binding(1, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment);
+	layout.create();
+
+	static constexpr u32 SETS = 1000;
+	GFX::DescriptorAllocator allocator(device);
+	context.measure("descriptor_alloc/1000_single", [&] {
+		for (u32 i = 0; i < SETS; i++) {
+			const auto set = allocator.allocate(layout);
+		}
+		allocator.reset();
+	});
+	context.measure("descriptor_alloc/1000_batched", [&] {
+		const auto sets = allocator.allocate(layout, SETS);
+		allocator.reset();
+	});
+}
+
+// Every worker records a copy into the shared one-time batch, which goes out in
+// a single submit, so all of them get the same ticket
+static void bench_one_time_commands(Context& context) {
+	auto& renderer = context.renderer();
+	auto& device = renderer.device();
+	auto& jobs = renderer.jobs();
+
+	static constexpr u32 COMMANDS = 64;
+	static constexpr vk::DeviceSize SIZE = 256;
+	GFX::Buffer source(
+		device,
+		SIZE,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+	);
+	GFX::Buffer destination(device, SIZE * COMMANDS, vk::BufferUsageFlagBits::eTransferDst);
+
+	context.measure("one_time/64_batched", [&] {
+		std::array<u64, COMMANDS> tickets {};
+		JobSystem::Counter recorded;
+		for (u32 i = 0; i < COMMANDS; i++) {
+			jobs.run(
+				[&device, &source, &destination, &tickets, i] {
+					const auto cmd = device.begin_one_time_command();
+					cmd->copyBuffer(*source.buffer(), *destination.buffer(), vk::BufferCopy(0, SIZE * i, SIZE));
+					tickets[i] = device.end_one_time_command(cmd);
+				},
+				JobSystem::Priority::High,
+				&recorded
+			);
+		}
+		jobs.wait(recorded, JobSystem::Priority::High);
+
+		if (!std::ranges::all_of(tickets, [&](const u64 ticket) { return ticket == tickets.front(); })) {
+			throw std::runtime_error("One-time commands recorded together were split across batches");
+		}
+		device.wait(tickets.front());
+		if (!std::ranges::all_of(tickets, [&](const u64 ticket) { return device.is_complete(ticket); })) {
+			throw std::runtime_error("One-time command tickets weren't complete after waiting");
+		}
+	});
+}
+
+void Bench::add_gfx_benchmarks(std::vector<Benchmark>& benchmarks) {
+	benchmarks.push_back({"buffer_write", bench_buffer_write});
+	benchmarks.push_back({"pipeline_create", bench_pipeline_create});
+	benchmarks.push_back({"descriptor_alloc", bench_descriptor_alloc});
+	benchmarks.push_back({"one_time", bench_one_time_commands});
+}
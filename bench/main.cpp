@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "bench.h"
+
+#include <vulxels/log.h>
+
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace Vulxels;
+
+static void print_usage() {
+	std::puts(
+		"Usage: vulxels_bench [options]\n"
+		"  --width <px>            Render width (default 1280)\n"
+		"  --height <px>           Render height (default 720)\n"
+		"  --frames <n>            Frames per macro benchmark (default 600)\n"
+		"  --iterations <n>        Iterations per micro benchmark (default 50)\n"
+		"  --warmup <n>            Unmeasured iterations first (default 5)\n"
+		"  --present-mode <mode>   immediate, mailbox, fifo or fifo-relaxed (default immediate)\n"
+		"  --seed <n>              Scene seed (default 1)\n"
+		"  --windowed              Render to a window instead of offscreen\n"
+		"  --device <index|name>   Use this GPU instead of the best scoring one\n"
+		"  --filter <text>         Only run benchmarks whose name contains text\n"
+		"  --output <path>         Write JSON results to a file instead of stdout\n"
+		"  --repeat <n>            Run the suite n times and use the median of each metric (default 1)\n"
+		"  --compare <path>        Check the results against a baseline JSON, fails on regressions\n"
+		"  --tolerance <percent>   Smallest slowdown counted as a regression (default 5)\n"
+		"  --allow-missing         Don't fail when a baseline metric wasn't produced, e.g. with --filter\n"
+		"  --list                  List the benchmarks and exit"
+	);
+}
+
+static vk::PresentModeKHR parse_present_mode(const std::string_view mode) {
+	if (mode == "immediate") {
+		return vk::PresentModeKHR::eImmediate;
+	}
+	if (mode == "mailbox") {
+		return vk::PresentModeKHR::eMailbox;
+	}
+	if (mode == "fifo") {
+		return vk::PresentModeKHR::eFifo;
+	}
+	if (mode == "fifo-relaxed") {
+		return vk::PresentModeKHR::eFifoRelaxed;
+	}
+	throw std::invalid_argument("Unknown present mode: " + std::string(mode));
+}
+
+int main(const int argc, char** argv) {
+	Bench::Options options;
+	bool list = false;
+
+	try {
+		for (int i = 1; i < argc; i++) {
+			const std::string_view arg = argv[i];
+			const auto value = [&] {
+				if (i + 1 >= argc) {
+					throw std::invalid_argument("Missing value for " + std::string(arg));
+				}
+				return std::string(argv[++i]);
+			};
+
+			if (arg == "--width") {
+				options.extent.width = std::stoul(value());
+			} else if (arg == "--height") {
+				options.extent.height = std::stoul(value());
+			} else if (arg == "--frames") {
+				options.frames = std::stoul(value());
+			} else if (arg == "--iterations") {
+				options.iterations = std::stoul(value());
+			} else if (arg == "--warmup") {
+				options.warmup = std::stoul(value());
+			} else if (arg == "--present-mode") {
+				options.present_mode = parse_present_mode(value());
+			} else if (arg == "--seed") {
+				options.seed = std::stoull(value());
+			} else if (arg == "--windowed") {
+				options.windowed = true;
+			} else if (arg == "--device") {
+				options.device = value();
+			} else if (arg == "--filter") {
+				options.filter = value();
+			} else if (arg == "--output") {
+				options.output = value();
+			} else if (arg == "--repeat") {
+				options.repeat = std::max(1ul, std::stoul(value()));
+			} else if (arg == "--compare") {
+				options.compare = value();
+			} else if (arg == "--tolerance") {
+				options.tolerance = std::stod(value()) / 100.0;
+			} else if (arg == "--allow-missing") {
+				options.allow_missing = true;
+			} else if (arg == "--list") {
+				list = true;
+			} else if (arg == "--help" || arg == "-h") {
+				print_usage();
+				return EXIT_SUCCESS;
+			} else {
+				throw std::invalid_argument("Unknown option: " + std::string(arg));
+			}
+		}
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "%s\n", e.what());
+		print_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Shaders are loaded relative to the executable, the output and baseline paths aren't
+	if (!options.output.empty()) {
+		options.output = std::filesystem::absolute(options.output).string();
+	}
+	if (!options.compare.empty()) {
+		options.compare = std::filesystem::absolute(options.compare).string();
+	}
+	std::filesystem::current_path(std::filesystem::path(argv[0]).parent_path());
+
+	std::vector<Bench::Benchmark> benchmarks;
+	Bench::add_gfx_benchmarks(benchmarks);
+	Bench::add_flythrough_benchmarks(benchmarks);
+	Bench::add_world_benchmarks(benchmarks);
+
+	if (list) {
+		for (const auto& benchmark : benchmarks) {
+			std::puts(benchmark.name.c_str());
+		}
+		return EXIT_SUCCESS;
+	}
+
+	// Keep stdout clean for the JSON
+	spdlog::set_default_logger(spdlog::stderr_color_mt("bench"));
+
+	try {
+		Bench::Context context(options);
+		for (u32 run = 0; run < options.repeat; run++) {
+			for (const auto& benchmark : benchmarks) {
+				if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+					continue;
+				}
+				VX_LOG("Running {} ({}/{})", benchmark.name, run + 1, options.repeat);
+				benchmark.run(context);
+			}
+			context.end_run();
+		}
+
+		const auto json = Bench::to_json(context);
+		if (options.output.empty()) {
+			std::cout << json;
+		} else {
+			std::ofstream(options.output, std::ios::trunc) << json;
+			VX_LOG("Wrote results: \"{}\"", options.output);
+		}
+
+		if (!options.compare.empty() && !Bench::compare(context, options.compare)) {
+			return EXIT_FAILURE;
+		}
+	} catch (const std::exception& e) {
+		VX_CRIT("Benchmark failed: {}", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
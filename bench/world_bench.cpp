@@ -0,0 +1,282 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "bench.h"
+
+#include <vulxels/log.h>
+#include <vulxels/world/chunk_map.h>
+#include <vulxels/world/mesher.h>
+#include <vulxels/world/terrain.h>
+
+#include <algorithm>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+using namespace Vulxels;
+using namespace Vulxels::Bench;
+
+namespace {
+	// 64×32×64 chunks, 131072 resident around the origin
+	constexpr glm::ivec3 REGION_MIN {-32, -16, -32};
+	constexpr glm::ivec3 REGION_MAX {32, 16, 32};
+	constexpr u32 LOOKUPS = 1 << 20;
+
+	// Stored in place of a chunk, so only the containers themselves are measured
+	using Value = u64;
+	using UnorderedMap = std::unordered_map<glm::ivec3, Value>;
+
+	// Written so the lookups can't be optimised away
+	volatile u64 s_sink = 0;
+
+	std::vector<glm::ivec3> region_coords() {
+		std::vector<glm::ivec3> coords;
+		for (i32 y = REGION_MIN.y; y < REGION_MAX.y; y++) {
+			for (i32 z = REGION_MIN.z; z < REGION_MAX.z; z++) {
+				for (i32 x = REGION_MIN.x; x < REGION_MAX.x; x++) {
+					coords.emplace_back(x, y, z);
+				}
+			}
+		}
+		return coords;
+	}
+
+	void fill(World::ChunkMap<Value>& map, const std::vector<glm::ivec3>& coords) {
+		for (usize i = 0; i < coords.size(); i++) {
+			map.try_emplace(coords[i], i + 1);
+		}
+	}
+
+	void fill(UnorderedMap& map, const std::vector<glm::ivec3>& coords) {
+		for (usize i = 0; i < coords.size(); i++) {
+			map.try_emplace(coords[i], i + 1);
+		}
+	}
+
+	// 12×6×12 chunks of generated terrain, from caves up through the peaks
+	constexpr glm::ivec3 TERRAIN_MIN {-6, -3, -6};
+	constexpr glm::ivec3 TERRAIN_MAX {6, 3, 6};
+
+	struct MeshJob {
+		const World::Chunk* chunk;
+		World::Mesher::Neighbours neighbours;
+	};
+
+	MeshJob mesh_job(const World::ChunkMap<World::Chunk>& chunks, const glm::ivec3 coord) {
+		return {chunks.find(coord), chunks.neighbours(coord)};
+	}
+
+	// Meshes every job once per iteration on this thread, recording chunks per second
+	void measure_throughput(Context& context, const std::string& name, const std::vector<MeshJob>& jobs) {
+		const auto& options = context.options();
+		auto mesher = std::make_unique<World::Mesher>();
+		std::vector<World::ChunkQuad> quads;
+		const auto run = [&] {
+			usize total = 0;
+			for (const auto& job : jobs) {
+				mesher->mesh(*job.chunk, job.neighbours, quads);
+				total += quads.size();
+			}
+			return total;
+		};
+
+		for (u32 i = 0; i < options.warmup; i++) {
+			s_sink = run();
+		}
+		auto& samples = context.result(name, "chunks/s").samples;
+		usize total = 0;
+		for (u32 i = 0; i < options.iterations; i++) {
+			const auto start = std::chrono::steady_clock::now();
+			total = run();
+			const auto end = std::chrono::steady_clock::now();
+			samples.push_back(static_cast<f64>(jobs.size()) / std::chrono::duration<f64>(end - start).count());
+		}
+		s_sink = total;
+		VX_LOG(
+			"{}: {} chunks, {:.1f} quads per chunk",
+			name,
+			jobs.size(),
+			static_cast<f64>(total) / static_cast<f64>(jobs.size())
+		);
+	}
+} // namespace
+
+static void bench_chunk_map(Context& context) {
+	const auto coords = region_coords();
+
+	// Inserted in a shuffled order, chunks don't load in coordinate order
+	std::mt19937_64 rng(context.options().seed);
+	auto shuffled = coords;
+	std::ranges::shuffle(shuffled, rng);
+
+	context.measure("chunk_map/insert/chunk_map", [&] {
+		World::ChunkMap<Value> map;
+		fill(map, shuffled);
+		s_sink = map.size();
+	});
+	context.measure("chunk_map/insert/unordered_map", [&] {
+		UnorderedMap map;
+		fill(map, shuffled);
+		s_sink = map.size();
+	});
+
+	World::ChunkMap<Value> chunk_map;
+	UnorderedMap unordered_map;
+	fill(chunk_map, shuffled);
+	fill(unordered_map, shuffled);
+
+	// Scattered lookups, a third of them outside the region
+	std::vector<glm::ivec3> random(LOOKUPS);
+	std::uniform_int_distribution<i32> dx(REGION_MIN.x - 16, REGION_MAX.x + 15);
+	std::uniform_int_distribution<i32> dy(REGION_MIN.y, REGION_MAX.y - 1);
+	std::uniform_int_distribution<i32> dz(REGION_MIN.z, REGION_MAX.z - 1);
+	for (auto& coord : random) {
+		coord = {dx(rng), dy(rng), dz(rng)};
+	}
+
+	context.measure("chunk_map/find_random/chunk_map", [&] {
+		u64 sum = 0;
+		for (const auto& coord : random) {
+			if (const auto* value = chunk_map.find(coord)) {
+				sum += *value;
+			}
+		}
+		s_sink = sum;
+	});
+	context.measure("chunk_map/find_random/unordered_map", [&] {
+		u64 sum = 0;
+		for (const auto& coord : random) {
+			if (const auto it = unordered_map.find(coord); it != unordered_map.end()) {
+				sum += it->second;
+			}
+		}
+		s_sink = sum;
+	});
+
+	// What meshing does, each chunk along with everything around it
+	context.measure("chunk_map/neighbours/chunk_map", [&] {
+		u64 sum = 0;
+		for (const auto& coord : coords) {
+			for (const auto* value : chunk_map.neighbours(coord)) {
+				sum += value ? *value : 0;
+			}
+		}
+		s_sink = sum;
+	});
+	context.measure("chunk_map/neighbours/unordered_map", [&] {
+		u64 sum = 0;
+		for (const auto& coord : coords) {
+			for (i32 y = -1; y <= 1; y++) {
+				for (i32 z = -1; z <= 1; z++) {
+					for (i32 x = -1; x <= 1; x++) {
+						const auto it = unordered_map.find(coord + glm::ivec3(x, y, z));
+						sum += it != unordered_map.end() ? it->second : 0;
+					}
+				}
+			}
+		}
+		s_sink = sum;
+	});
+
+	// Runs of lookups of the same chunk, like per-block queries from physics
+	context.measure("chunk_map/find_repeated/chunk_map", [&] {
+		u64 sum = 0;
+		for (u32 i = 0; i < LOOKUPS; i++) {
+			sum += *chunk_map.find(coords[(i >> 6) % coords.size()]);
+		}
+		s_sink = sum;
+	});
+	context.measure("chunk_map/find_repeated/unordered_map", [&] {
+		u64 sum = 0;
+		for (u32 i = 0; i < LOOKUPS; i++) {
+			sum += unordered_map.find(coords[(i >> 6) % coords.size()])->second;
+		}
+		s_sink = sum;
+	});
+}
+
+static void bench_mesher(Context& context) {
+	const World::TerrainGenerator generator(context.options().seed);
+	World::ChunkMap<World::Chunk> chunks;
+	for (i32 y = TERRAIN_MIN.y; y < TERRAIN_MAX.y; y++) {
+		for (i32 z = TERRAIN_MIN.z; z < TERRAIN_MAX.z; z++) {
+			for (i32 x = TERRAIN_MIN.x; x < TERRAIN_MAX.x; x++) {
+				generator.generate({x, y, z}, chunks[{x, y, z}]);
+			}
+		}
+	}
+
+	// Everything, including the sky and solid rock that mesh to little or
+	// nothing, and then just the chunks the surface or a cave passes through
+	std::vector<MeshJob> all;
+	std::vector<MeshJob> surface;
+	chunks.for_each([&](const glm::ivec3 coord, const World::Chunk& chunk) {
+		all.push_back(mesh_job(chunks, coord));
+		if (!chunk.uniform()) {
+			surface.push_back(all.back());
+		}
+	});
+	measure_throughput(context, "mesher/terrain", all);
+	measure_throughput(context, "mesher/surface", surface);
+
+	// Nothing merges and every face shows, the most quads a chunk can have
+	World::Chunk checkerboard;
+	for (u32 y = 0; y < World::Chunk::SIZE; y++) {
+		for (u32 z = 0; z < World::Chunk::SIZE; z++) {
+			for (u32 x = 0; x < World::Chunk::SIZE; x++) {
+				if ((x + y + z) % 2 == 0) {
+					checkerboard.set(x, y, z, World::Block::Stone);
+				}
+			}
+		}
+	}
+	measure_throughput(context, "mesher/checkerboard", {MeshJob {&checkerboard, {}}});
+}
+
+// Generates the mesher's terrain region over and over into chunks allocated
+// once, on this thread, recording chunks per second
+static void bench_generate(Context& context) {
+	const auto& options = context.options();
+	const World::TerrainGenerator generator(options.seed);
+	std::vector<glm::ivec3> coords;
+	for (i32 y = TERRAIN_MIN.y; y < TERRAIN_MAX.y; y++) {
+		for (i32 z = TERRAIN_MIN.z; z < TERRAIN_MAX.z; z++) {
+			for (i32 x = TERRAIN_MIN.x; x < TERRAIN_MAX.x; x++) {
+				coords.emplace_back(x, y, z);
+			}
+		}
+	}
+	std::vector<World::Chunk> chunks(coords.size());
+	const auto run = [&] {
+		for (usize i = 0; i < coords.size(); i++) {
+			generator.generate(coords[i], chunks[i]);
+		}
+		return chunks.back().get(0);
+	};
+
+	for (u32 i = 0; i < options.warmup; i++) {
+		s_sink = run();
+	}
+	auto& samples = context.result("world/generate", "chunks/s").samples;
+	for (u32 i = 0; i < options.iterations; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		s_sink = run();
+		const auto end = std::chrono::steady_clock::now();
+		samples.push_back(static_cast<f64>(coords.size()) / std::chrono::duration<f64>(end - start).count());
+	}
+}
+
+void Bench::add_world_benchmarks(std::vector<Benchmark>& benchmarks) {
+	benchmarks.push_back({"chunk_map", bench_chunk_map});
+	benchmarks.push_back({"world", bench_generate});
+	benchmarks.push_back({"mesher", bench_mesher});
+}
@@ -12,7 +12,7 @@
 namespace Vulxels {
 	class App {
 	  public:
-		App();
+		explicit App(const GFX::RendererConfig& config = {});
 		~App();
 		void run();
 
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class Device;
+	class Allocator;
+
+	class Allocation {
+	  public:
+		Allocation() = default;
+		~Allocation();
+
+		Allocation(const Allocation&) = delete;
+		Allocation& operator=(const Allocation&) = delete;
+		Allocation(Allocation&& other) noexcept;
+		Allocation& operator=(Allocation&& other) noexcept;
+
+		vk::DeviceMemory memory() const {
+			return m_memory;
+		}
+
+		vk::DeviceSize offset() const {
+			return m_offset;
+		}
+
+		vk::DeviceSize size() const {
+			return m_size;
+		}
+
+		u32 memory_type() const {
+			return m_memory_type;
+		}
+
+		// Host visible blocks are persistently mapped, nullptr otherwise
+		void* mapped() const {
+			return m_mapped;
+		}
+
+		explicit operator bool() const {
+			return m_allocator != nullptr;
+		}
+
+	  private:
+		Allocator* m_allocator = nullptr;
+		void* m_block = nullptr;
+		vk::DeviceMemory m_memory;
+		vk::DeviceSize m_offset = 0;
+		vk::DeviceSize m_size = 0;
+		u32 m_memory_type = 0;
+		void* m_mapped = nullptr;
+
+		void release();
+
+		friend class Allocator;
+	};
+
+	class Allocator {
+	  public:
+		static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+		struct Statistics {
+			u32 block_count = 0;
+			u32 allocation_count = 0;
+			u32 free_range_count = 0;
+			vk::DeviceSize bytes_reserved = 0;
+			vk::DeviceSize bytes_used = 0;
+			vk::DeviceSize largest_free_range = 0;
+
+			// 0 when all free space is contiguous, approaches 1 as it splinters
+			f32 fragmentation() const {
+				const vk::DeviceSize free = bytes_reserved - bytes_used;
+				if (free == 0) {
+					return 0.0f;
+				}
+				return 1.0f - static_cast<f32>(largest_free_range) / static_cast<f32>(free);
+			}
+		};
+
+		explicit Allocator(Device& device, vk::DeviceSize block_size = DEFAULT_BLOCK_SIZE);
+		~Allocator() = default;
+
+		Allocator(const Allocator&) = delete;
+		Allocator& operator=(const Allocator&) = delete;
+
+		Allocation
+		allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, bool linear = true);
+
+		Statistics statistics() const;
+		Statistics statistics(u32 memory_type) const;
+
+		u32 find_memory_type(u32 type_filter, vk::MemoryPropertyFlags properties) const;
+
+		const vk::PhysicalDeviceMemoryProperties& memory_properties() const {
+			return m_memory_properties;
+		}
+
+		vk::DeviceSize atom_size() const {
+			return m_atom_size;
+		}
+
+	  private:
+		struct Block {
+			vk::raii::DeviceMemory memory = nullptr;
+			vk::DeviceSize size = 0;
+			vk::DeviceSize used = 0;
+			u32 memory_type = 0;
+			u32 allocation_count = 0;
+			void* mapped = nullptr;
+			std::map<vk::DeviceSize, vk::DeviceSize> free_by_offset;
+			std::multimap<vk::DeviceSize, vk::DeviceSize> free_by_size;
+
+			void insert_free(vk::DeviceSize offset, vk::DeviceSize size);
+			void erase_free(std::map<vk::DeviceSize, vk::DeviceSize>::iterator it);
+		};
+
+		Device& m_device;
+		vk::DeviceSize m_block_size;
+		vk::PhysicalDeviceMemoryProperties m_memory_properties;
+		vk::DeviceSize m_granularity;
+		vk::DeviceSize m_atom_size;
+		std::vector<std::vector<std::unique_ptr<Block>>> m_blocks; // indexed by memory type
+		mutable std::mutex m_mutex;
+
+		Block& create_block(u32 memory_type, vk::DeviceSize size);
+		static bool allocate_from(Block& block, vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset);
+		void free(Allocation& allocation);
+		void accumulate(const Block& block, Statistics& stats) const;
+
+		friend class Allocation;
+	};
+} // namespace Vulxels::GFX
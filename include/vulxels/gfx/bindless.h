@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/descriptors.h>
+#include <vulxels/gfx/device.h>
+#include <vulxels/types.h>
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	// One large update-after-bind set holding every sampled image, storage buffer
+	// and sampler, shaders index into the arrays with indices passed through push
+	// constants instead of binding a set per draw. Requires descriptor indexing.
+	class BindlessTable {
+	  public:
+		static constexpr u32 IMAGE_BINDING = 0;
+		static constexpr u32 BUFFER_BINDING = 1;
+		static constexpr u32 SAMPLER_BINDING = 2;
+
+		static constexpr u32 DEFAULT_MAX_IMAGES = 16384;
+		static constexpr u32 DEFAULT_MAX_BUFFERS = 16384;
+		static constexpr u32 MAX_SAMPLERS = 32;
+
+		// Returned for resources that have no slot
+		static constexpr u32 INVALID_INDEX = ~0u;
+
+		explicit BindlessTable(
+			Device& device,
+			u32 max_images = DEFAULT_MAX_IMAGES,
+			u32 max_buffers = DEFAULT_MAX_BUFFERS
+		);
+		~BindlessTable() = default;
+
+		BindlessTable(const BindlessTable&) = delete;
+		BindlessTable& operator=(const BindlessTable&) = delete;
+
+		DescriptorLayout& layout() {
+			return m_layout;
+		}
+
+		vk::DescriptorSet set() const {
+			return m_set->set();
+		}
+
+		u32 max_images() const {
+			return m_images.capacity;
+		}
+
+		u32 max_buffers() const {
+			return m_buffers.capacity;
+		}
+
+		// Each returns the array index for the shader to use, the view or buffer
+		// must stay alive until it is removed and no submitted frame still uses it.
+		// A removed index isn't handed out again until every frame that may have
+		// read it has completed, see update() and recycle().
+		u32 add_image(vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+		void update_image(u32 index, vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+		void remove_image(u32 index);
+
+		u32 add_buffer(const vk::raii::Buffer& buffer, vk::DeviceSize range = VK_WHOLE_SIZE, vk::DeviceSize offset = 0);
+		void remove_buffer(u32 index);
+
+		u32 add_sampler(vk::Sampler sampler);
+
+		// Writes descriptors queued since the last call, must happen before the
+		// command buffers that read them are submitted. Indices removed since the
+		// last call are held back until `frame`, the one about to be submitted.
+		void update(u64 frame);
+
+		// Makes indices held back for frames up to `completed` available again
+		void recycle(u64 completed);
+
+		void bind(
+			const vk::raii::CommandBuffer& cmd,
+			vk::PipelineLayout layout,
+			u32 set_index = 0,
+			vk::PipelineBindPoint bind_point = vk::PipelineBindPoint::eGraphics
+		) const;
+
+	  private:
+		// Hands out indices, recycling released ones before growing. Released
+		// indices wait to be stamped with a frame and then for it to complete.
+		struct Slots {
+			u32 capacity = 0;
+			u32 next = 0;
+			std::vector<u32> free;
+			std::vector<u32> released;
+			std::deque<std::pair<u64, u32>> retired;
+
+			u32 acquire();
+			void release(u32 index);
+			void retire(u64 frame);
+			void recycle(u64 completed);
+		};
+
+		DescriptorLayout m_layout;
+		DescriptorPool m_pool;
+		std::optional<DescriptorSet> m_set;
+		Slots m_images;
+		Slots m_buffers;
+		Slots m_samplers;
+		std::mutex m_mutex;
+
+		void flush_if_full();
+	};
+} // namespace Vulxels::GFX
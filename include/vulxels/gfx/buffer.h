@@ -6,12 +6,14 @@
 
 #pragma once
 
+#include <vulxels/gfx/allocator.h>
 #include <vulxels/gfx/device.h>
 #include <vulxels/types.h>
 
 #include <iterator>
 #include <memory>
 #include <ranges>
+#include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace Vulxels::GFX {
@@ -23,7 +25,7 @@ namespace Vulxels::GFX {
 			vk::BufferUsageFlags usage,
 			vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eDeviceLocal
 		);
-		~Buffer() = default;
+		~Buffer();
 
 		Buffer(const Buffer&) = delete;
 		Buffer& operator=(const Buffer&) = delete;
@@ -34,37 +36,49 @@ namespace Vulxels::GFX {
 			return m_buffer;
 		}
 
+		const Allocation& allocation() const {
+			return m_allocation;
+		}
+
+		vk::DeviceSize size() const {
+			return m_size;
+		}
+
 		void* map(vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0);
 		void unmap();
 		void flush(vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0) const;
 		void invalidate(vk::DeviceSize size = VK_WHOLE_SIZE, vk::DeviceSize offset = 0) const;
-		void write(const void* data, vk::DeviceSize size, vk::DeviceSize offset = 0);
+
+		// Returns the upload timeline value to wait on before the data is read, or 0
+		// when the buffer is host visible and the write is already complete
+		u64 write(const void* data, vk::DeviceSize size, vk::DeviceSize offset = 0);
 
 		template<typename Iter>
 			requires std::contiguous_iterator<Iter>
-		void write(Iter begin, Iter end, const vk::DeviceSize offset = 0) {
-			write(std::addressof(*begin), std::distance(begin, end) * sizeof(*begin), offset);
+		u64 write(Iter begin, Iter end, const vk::DeviceSize offset = 0) {
+			return write(std::addressof(*begin), std::distance(begin, end) * sizeof(*begin), offset);
 		}
 
 		template<typename R>
 			requires std::ranges::contiguous_range<R>
-		void write(R&& range, const vk::DeviceSize offset = 0) {
-			write(std::ranges::begin(range), std::ranges::end(range), offset);
+		u64 write(R&& range, const vk::DeviceSize offset = 0) {
+			return write(std::ranges::begin(range), std::ranges::end(range), offset);
 		}
 
 	  private:
 		Device& m_device;
+		Allocation m_allocation;
 		vk::raii::Buffer m_buffer = nullptr;
-		vk::raii::DeviceMemory m_memory = nullptr;
 
 		vk::DeviceSize m_size;
 		vk::BufferUsageFlags m_usage;
 		vk::MemoryPropertyFlags m_properties;
 
-		std::unique_ptr<Buffer> m_staging = nullptr;
-		vk::DeviceSize m_staging_size = 0;
+		std::vector<u8> m_staging; // mappings too big for the staging ring
+		vk::DeviceSize m_staging_size = 0; // while mapped, 0 otherwise
 		vk::DeviceSize m_staging_offset = 0;
+		vk::DeviceSize m_staging_ring_offset = 0;
 
-		u32 find_memory_type(u32 type_filter, vk::MemoryPropertyFlags properties) const;
+		vk::MappedMemoryRange mapped_range(vk::DeviceSize size, vk::DeviceSize offset) const;
 	};
 } // namespace Vulxels::GFX
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/bindless.h>
+#include <vulxels/gfx/buffer.h>
+#include <vulxels/gfx/descriptors.h>
+#include <vulxels/gfx/pipeline_library.h>
+#include <vulxels/gfx/render_graph.h>
+#include <vulxels/types.h>
+#include <vulxels/world/chunk_map.h>
+#include <vulxels/world/mesher.h>
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class Renderer;
+
+	// Draws meshed chunks without vertex buffers. Each chunk's quads sit as they
+	// are in a storage buffer of its own, 8 bytes a quad, and voxel.vert pulls
+	// them by gl_VertexIndex through an index buffer shared by every chunk. The
+	// buffers are registered with the bindless table, which is bound once per
+	// secondary buffer, and each draw pushes its buffer's index. Without one,
+	// every chunk gets a set from the frame's descriptors instead.
+	class ChunkRenderer {
+	  public:
+		// Fewer chunks than this per secondary buffer aren't worth another thread
+		static constexpr usize MIN_BATCH = 64;
+
+		struct Stats {
+			u32 chunks = 0;
+			u64 quads = 0;
+			vk::DeviceSize memory = 0; // quad buffers, not counting the shared indices
+		};
+
+		ChunkRenderer(Renderer& renderer, RenderGraph& graph, vk::Format color_format, vk::Format depth_format);
+		~ChunkRenderer();
+
+		ChunkRenderer(const ChunkRenderer&) = delete;
+		ChunkRenderer& operator=(const ChunkRenderer&) = delete;
+
+		const Stats& stats() const {
+			return m_stats;
+		}
+
+		// Compiled in the background, nothing is drawn until it's ready
+		const PipelineLibrary::Handle& pipeline() const {
+			return m_pipeline;
+		}
+
+		// Replaces the chunk's mesh, the old one is destroyed once no frame uses it
+		void upload(glm::ivec3 coord, std::span<const World::ChunkQuad> quads);
+		void remove(glm::ivec3 coord);
+
+		// Records into secondary buffers across the workers, the pass must use them
+		void draw(const RenderGraph::PassContext& context, const glm::mat4& view_proj);
+
+	  private:
+		struct PushConstants {
+			glm::mat4 view_proj;
+			glm::ivec4 origin; // w is the quad buffer's bindless index
+		};
+
+		struct Mesh {
+			Buffer quads;
+			u32 index; // BindlessTable::INVALID_INDEX without one
+			u32 count;
+		};
+
+		Renderer& m_renderer;
+		BindlessTable* m_bindless;
+		DescriptorLayout m_layout; // Only created without a bindless table
+		Buffer m_indices;
+		PipelineLibrary::Handle m_pipeline;
+		World::ChunkMap<std::unique_ptr<Mesh>> m_meshes;
+		std::vector<std::pair<glm::ivec3, const Mesh*>> m_draws;
+		std::vector<DescriptorSet> m_sets;
+		Stats m_stats;
+
+		void release(std::unique_ptr<Mesh>& mesh);
+	};
+} // namespace Vulxels::GFX
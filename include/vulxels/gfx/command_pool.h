@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class Device;
+
+	// Recycles command buffers once the timeline value they were submitted under
+	// has completed. Not thread safe, each recording thread should own one.
+	class CommandPool {
+	  public:
+		CommandPool(Device& device, u32 family, vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary);
+		~CommandPool() = default;
+
+		CommandPool(const CommandPool&) = delete;
+		CommandPool& operator=(const CommandPool&) = delete;
+
+		vk::raii::CommandPool& pool() {
+			return m_pool;
+		}
+
+		usize size() const {
+			return m_buffers.size();
+		}
+
+		vk::raii::CommandBuffer* acquire(u64 completed);
+		void release(vk::raii::CommandBuffer* cmd, u64 value);
+
+	  private:
+		Device& m_device;
+		vk::raii::CommandPool m_pool = nullptr;
+		vk::CommandBufferLevel m_level;
+		std::vector<std::unique_ptr<vk::raii::CommandBuffer>> m_buffers;
+		std::vector<vk::raii::CommandBuffer*> m_free;
+		std::deque<std::pair<u64, vk::raii::CommandBuffer*>> m_pending;
+	};
+} // namespace Vulxels::GFX
@@ -9,6 +9,8 @@
 #include <vulxels/gfx/device.h>
 #include <vulxels/types.h>
 
+#include <array>
+#include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace Vulxels::GFX {
@@ -29,21 +31,37 @@ namespace Vulxels::GFX {
 			vk::DescriptorType type,
 			vk::ShaderStageFlags stages,
 			u32 count = 1,
-			const vk::Sampler* samplers = nullptr
+			const vk::Sampler* samplers = nullptr,
+			vk::DescriptorBindingFlags flags = {}
 		);
 
+		void set_flags(const vk::DescriptorSetLayoutCreateFlags flags) {
+			m_flags = flags;
+		}
+
 		void create();
 
+		// Of the bindings and flags it was created with, so equal layouts hash equally
+		u64 hash() const {
+			return m_hash;
+		}
+
 	  private:
 		Device& m_device;
 		vk::raii::DescriptorSetLayout m_layout = nullptr;
 		std::vector<vk::DescriptorSetLayoutBinding> m_bindings;
+		std::vector<vk::DescriptorBindingFlags> m_binding_flags;
+		vk::DescriptorSetLayoutCreateFlags m_flags;
+		u64 m_hash = 0;
 	};
 
 	class DescriptorPool;
+	class DescriptorAllocator;
 
 	class DescriptorSet {
 	  public:
+		static constexpr u32 MAX_WRITES = 16;
+
 		DescriptorSet() = delete;
 		~DescriptorSet() = default;
 
@@ -52,23 +70,62 @@ namespace Vulxels::GFX {
 		DescriptorSet(DescriptorSet&&) = default;
 		DescriptorSet& operator=(DescriptorSet&&) = default;
 
-		vk::raii::DescriptorSet& set() {
+		vk::DescriptorSet set() const {
 			return m_set;
 		}
 
 		void bind_buffer(u32 binding, const vk::raii::Buffer& buffer, vk::DeviceSize range, vk::DeviceSize offset = 0);
-		// TODO: Add other bind methods
+		void bind_storage_buffer(
+			u32 binding,
+			const vk::raii::Buffer& buffer,
+			vk::DeviceSize range,
+			vk::DeviceSize offset = 0,
+			u32 element = 0
+		);
+		void bind_dynamic_buffer(
+			u32 binding,
+			const vk::raii::Buffer& buffer,
+			vk::DeviceSize range,
+			vk::DescriptorType type = vk::DescriptorType::eUniformBufferDynamic
+		);
+		void bind_image(
+			u32 binding,
+			vk::ImageView view,
+			vk::ImageLayout layout,
+			vk::Sampler sampler = nullptr,
+			u32 element = 0
+		);
+		void bind_storage_image(u32 binding, vk::ImageView view, u32 element = 0);
+		void bind_sampler(u32 binding, vk::Sampler sampler, u32 element = 0);
+
+		u32 pending() const {
+			return m_count;
+		}
 
 		void write() const;
+		void clear() {
+			m_count = 0;
+		}
 
 	  private:
-		vk::raii::DescriptorSet m_set = nullptr;
-		std::vector<vk::WriteDescriptorSet> m_writes;
-		std::vector<vk::DescriptorBufferInfo> m_buffer_infos;
+		vk::raii::DescriptorSet m_owned = nullptr;
+		vk::DescriptorSet m_set;
+		const vk::raii::Device* m_device;
+
+		// Fixed storage so building writes never allocates, the info pointers are
+		// only resolved in write() so moving the set can't leave them dangling
+		std::array<vk::WriteDescriptorSet, MAX_WRITES> m_writes;
+		std::array<vk::DescriptorBufferInfo, MAX_WRITES> m_buffer_infos;
+		std::array<vk::DescriptorImageInfo, MAX_WRITES> m_image_infos;
+		u32 m_count = 0;
+
+		DescriptorSet(const vk::raii::Device& device, vk::raii::DescriptorSet&& set);
+		DescriptorSet(const vk::raii::Device& device, vk::DescriptorSet set);
 
-		explicit DescriptorSet(vk::raii::DescriptorSet&& set) : m_set(std::move(set)) {}
+		vk::WriteDescriptorSet& next_write(u32 binding, vk::DescriptorType type, u32 element = 0);
 
 		friend class DescriptorPool;
+		friend class DescriptorAllocator;
 	};
 
 	class DescriptorPool {
@@ -91,15 +148,67 @@ namespace Vulxels::GFX {
 			m_max_sets = max;
 		}
 
+		// Added to eFreeDescriptorSet, e.g. eUpdateAfterBind for bindless layouts
+		void set_flags(const vk::DescriptorPoolCreateFlags flags) {
+			m_flags = flags;
+		}
+
 		void create();
 
 		DescriptorSet allocate(DescriptorLayout& layout) const;
-		// TODO: Add a method to allocate multiple descriptor sets
+		std::vector<DescriptorSet> allocate(DescriptorLayout& layout, u32 count) const;
 
 	  private:
 		Device& m_device;
 		vk::raii::DescriptorPool m_pool = nullptr;
 		std::vector<vk::DescriptorPoolSize> m_sizes;
 		u32 m_max_sets = 0;
+		vk::DescriptorPoolCreateFlags m_flags;
+	};
+
+	// Linear allocator for short-lived sets, grows by adding pools on demand and
+	// is reset as a whole rather than freeing sets one by one
+	class DescriptorAllocator {
+	  public:
+		static constexpr u32 INITIAL_SETS = 64;
+		static constexpr u32 MAX_SETS = 4096;
+
+		// Ratios are descriptors of each type per set
+		DescriptorAllocator(Device& device, std::vector<vk::DescriptorPoolSize> ratios = default_ratios());
+		~DescriptorAllocator() = default;
+
+		DescriptorAllocator(const DescriptorAllocator&) = delete;
+		DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+		DescriptorAllocator(DescriptorAllocator&&) = default;
+
+		DescriptorSet allocate(DescriptorLayout& layout);
+		std::vector<DescriptorSet> allocate(DescriptorLayout& layout, u32 count);
+		void reset();
+
+		usize pool_count() const {
+			return m_ready.size() + m_full.size();
+		}
+
+		static std::vector<vk::DescriptorPoolSize> default_ratios() {
+			return {
+				{vk::DescriptorType::eUniformBuffer, 2},
+				{vk::DescriptorType::eUniformBufferDynamic, 1},
+				{vk::DescriptorType::eStorageBuffer, 2},
+				{vk::DescriptorType::eStorageBufferDynamic, 1},
+				{vk::DescriptorType::eCombinedImageSampler, 2},
+				{vk::DescriptorType::eSampledImage, 2},
+				{vk::DescriptorType::eStorageImage, 1},
+			};
+		}
+
+	  private:
+		Device& m_device;
+		std::vector<vk::DescriptorPoolSize> m_ratios;
+		std::vector<vk::raii::DescriptorPool> m_ready;
+		std::vector<vk::raii::DescriptorPool> m_full;
+		u32 m_sets_per_pool = INITIAL_SETS;
+
+		vk::raii::DescriptorPool create_pool(u32 sets) const;
+		void allocate_into(DescriptorLayout& layout, u32 count, vk::DescriptorSet* sets);
 	};
 } // namespace Vulxels::GFX
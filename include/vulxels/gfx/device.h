@@ -6,13 +6,24 @@
 
 #pragma once
 
+#include <vulxels/gfx/allocator.h>
+#include <vulxels/gfx/command_pool.h>
 #include <vulxels/gfx/instance.h>
+#include <vulxels/gfx/pipeline_cache.h>
 #include <vulxels/gfx/queue.h>
+#include <vulxels/gfx/timeline.h>
 #include <vulxels/gfx/window.h>
 #include <vulxels/types.h>
 
 #include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace Vulxels::GFX {
@@ -22,10 +33,23 @@ namespace Vulxels::GFX {
 		std::vector<vk::PresentModeKHR> present_modes;
 	};
 
+	// Optional capabilities, enabled when the physical device supports them
+	struct DeviceFeatures {
+		bool bindless = false;
+		bool dynamic_rendering = false; // VK_KHR_dynamic_rendering, no render pass or framebuffer objects
+		bool present_wait = false; // VK_KHR_present_id and VK_KHR_present_wait, never when headless
+	};
+
+	class StagingRing;
+
 	class Device {
 	  public:
-		Device(Instance& instance, const Window& window);
-		~Device() = default;
+		// The most capable suitable device is used unless `preferred` names one,
+		// either by its index in the device list or part of its name
+		Device(Instance& instance, const Window& window, std::string_view preferred = {});
+		// Headless, without a surface or swapchain support
+		explicit Device(Instance& instance, std::string_view preferred = {});
+		~Device();
 
 		Device(const Device&) = delete;
 		Device& operator=(const Device&) = delete;
@@ -34,6 +58,10 @@ namespace Vulxels::GFX {
 			return m_surface;
 		}
 
+		bool headless() const {
+			return !*m_surface;
+		}
+
 		vk::raii::PhysicalDevice& physical_device() {
 			return m_physical_device;
 		}
@@ -46,6 +74,22 @@ namespace Vulxels::GFX {
 			return m_primary_pool;
 		}
 
+		const DeviceFeatures& features() const {
+			return m_features;
+		}
+
+		Allocator& allocator() {
+			return *m_allocator;
+		}
+
+		PipelineCache& pipeline_cache() {
+			return *m_pipeline_cache;
+		}
+
+		StagingRing& staging() {
+			return *m_staging;
+		}
+
 		Queue& graphics_queue() {
 			return m_graphics_queue;
 		}
@@ -54,10 +98,18 @@ namespace Vulxels::GFX {
 			return m_present_queue;
 		}
 
-		void wait_idle() const {
-			m_device.waitIdle();
+		Queue& transfer_queue() {
+			return m_transfer_queue;
+		}
+
+		// Same family as the graphics queue when there's no separate compute family
+		Queue& compute_queue() {
+			return m_compute_queue;
 		}
 
+		// Holds every queue's lock, waiting for the device counts as using them all
+		void wait_idle() const;
+
 		bool wait_for_fence(const vk::raii::Fence& fence, const u64 timeout = std::numeric_limits<u64>::max()) const {
 			const auto res = m_device.waitForFences({*fence}, VK_TRUE, timeout);
 			if (res != vk::Result::eSuccess && res != vk::Result::eTimeout) {
@@ -67,20 +119,45 @@ namespace Vulxels::GFX {
 		}
 
 		SwapchainSupportDetails query_swapchain_support() const;
-		vk::raii::CommandBuffer* begin_one_time_command() const;
-		void end_one_time_command(const vk::raii::CommandBuffer* cmd) const;
+
+		// One-time commands are recorded from a per-thread pool and batched, ending
+		// one returns a ticket that completes once the batch it joined has executed
+		vk::raii::CommandBuffer* begin_one_time_command();
+		u64 end_one_time_command(vk::raii::CommandBuffer* cmd);
+		u64 submit_one_time_commands();
+		bool is_complete(u64 ticket) const;
+		void wait(u64 ticket);
+
+		// Signalled with each batch's ticket, submissions depending on them wait on it
+		Timeline& one_time_timeline() {
+			return *m_one_time_timeline;
+		}
 
 	  private:
 		Instance& m_instance;
 		vk::raii::SurfaceKHR m_surface = nullptr;
 		vk::raii::PhysicalDevice m_physical_device = nullptr;
 		vk::raii::Device m_device = nullptr;
+		DeviceFeatures m_features;
 		vk::raii::CommandPool m_primary_pool = nullptr;
-		vk::raii::CommandPool m_secondary_pool = nullptr;
 		Queue m_graphics_queue;
 		Queue m_present_queue;
-
-		void pick_physical_device();
+		Queue m_transfer_queue;
+		Queue m_compute_queue;
+		std::vector<std::shared_ptr<std::mutex>> m_queue_mutexes; // one per family in use
+		std::unique_ptr<Allocator> m_allocator;
+		std::unique_ptr<StagingRing> m_staging;
+		std::unique_ptr<PipelineCache> m_pipeline_cache;
+
+		std::unique_ptr<Timeline> m_one_time_timeline;
+		std::unordered_map<std::thread::id, std::unique_ptr<CommandPool>> m_one_time_pools;
+		std::vector<vk::CommandBuffer> m_one_time_batch;
+		mutable std::mutex m_one_time_mutex;
+
+		void init(std::string_view preferred);
+		void pick_physical_device(std::string_view preferred);
+		// Higher is better, nullopt when the device can't run the renderer at all
+		std::optional<u64> rate_physical_device(const vk::raii::PhysicalDevice& device) const;
 		void create_logical_device(const std::set<u32>& queues);
 		void create_command_pool();
 	};
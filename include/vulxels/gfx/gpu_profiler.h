@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/device.h>
+#include <vulxels/types.h>
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	// Timestamp queries around named regions of the frame command buffer. Each
+	// frame slot has its own query pool which is read back when the slot comes
+	// around again, so results are a frame or more late but never stall.
+	class GpuProfiler {
+	  public:
+		static constexpr u32 MAX_SCOPES = 64;
+		static constexpr u32 HISTORY = 240;
+
+		struct Timing {
+			std::string name;
+			u32 depth;
+			f64 ms;
+		};
+
+		// Closes the scope when it goes out of scope
+		class Scope {
+		  public:
+			Scope(GpuProfiler& profiler, const vk::raii::CommandBuffer& cmd, const std::string_view name) :
+				m_profiler(profiler),
+				m_cmd(cmd),
+				m_index(profiler.begin(cmd, name)) {}
+			~Scope() {
+				m_profiler.end(m_cmd, m_index);
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		  private:
+			GpuProfiler& m_profiler;
+			const vk::raii::CommandBuffer& m_cmd;
+			u32 m_index;
+		};
+
+		GpuProfiler(Device& device, u32 frames);
+		~GpuProfiler() = default;
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		bool supported() const {
+			return m_period > 0.0;
+		}
+
+		// Collects the slot's previous results, resets its queries and opens the
+		// frame scope, must be recorded outside a render pass
+		void begin_frame(const vk::raii::CommandBuffer& cmd, u32 slot);
+		void end_frame(const vk::raii::CommandBuffer& cmd);
+
+		// Returns the index to pass to end(), scopes may nest
+		u32 begin(const vk::raii::CommandBuffer& cmd, std::string_view name);
+		void end(const vk::raii::CommandBuffer& cmd, u32 index);
+
+		// Most recent complete frame, the first entry is the whole frame
+		const std::vector<Timing>& timings() const {
+			return m_timings;
+		}
+
+		// Number of frames read back so far, changes when timings() is replaced
+		u64 frames_collected() const {
+			return m_collected;
+		}
+
+		// Whole frame GPU times in milliseconds, oldest first
+		const std::deque<f32>& history() const {
+			return m_history;
+		}
+
+		// Writes every frame still in the history as CSV rows of frame, scope,
+		// depth and milliseconds
+		void export_csv(const std::string& path) const;
+
+	  private:
+		struct Frame {
+			vk::raii::QueryPool pool = nullptr;
+			std::vector<std::string> names;
+			std::vector<u32> depths;
+			u64 number = 0;
+			bool pending = false;
+		};
+
+		std::vector<Frame> m_frames;
+		Frame* m_current = nullptr;
+		f64 m_period = 0.0; // nanoseconds per tick
+		u64 m_mask = 0;
+		u32 m_depth = 0;
+		u32 m_frame_scope = 0;
+		u64 m_frame_number = 0;
+		u64 m_collected = 0;
+
+		std::vector<Timing> m_timings;
+		std::deque<f32> m_history;
+		std::deque<std::pair<u64, std::vector<Timing>>> m_recorded;
+
+		void collect(Frame& frame);
+	};
+} // namespace Vulxels::GFX
@@ -18,7 +18,8 @@ namespace Vulxels::GFX {
 
 	class Instance {
 	  public:
-		Instance();
+		// Headless instances don't enable the window system extensions
+		explicit Instance(bool headless = false);
 
 		Instance(const Instance&) = delete;
 		Instance& operator=(const Instance&) = delete;
@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <vulxels/gfx/descriptors.h>
 #include <vulxels/gfx/device.h>
+#include <vulxels/gfx/shader.h>
+#include <vulxels/hash.h>
 
 #include <memory>
 #include <string_view>
@@ -22,9 +25,13 @@ namespace Vulxels::GFX {
 
 			Builder(const Builder&) = delete;
 			Builder& operator=(const Builder&) = delete;
+			Builder(Builder&&) = default;
 
+			// Keyed on `hash` rather than the handle, which the driver may hand out
+			// again once the module is destroyed, so it must identify the code
 			Builder& add_shader_stage(
 				const vk::ShaderModule module,
+				const u64 hash,
 				const vk::ShaderStageFlagBits stage,
 				const std::string_view entry = "main"
 			) {
@@ -33,6 +40,26 @@ namespace Vulxels::GFX {
 				shader_stage.setModule(module);
 				shader_stage.setPName(entry.data());
 				shader_stages.push_back(shader_stage);
+				shader_hashes.push_back(hash);
+				return *this;
+			}
+
+			Builder& add_shader_stage(
+				Shader& shader,
+				const vk::ShaderStageFlagBits stage,
+				const std::string_view entry = "main"
+			) {
+				return add_shader_stage(*shader.module(), shader.hash(), stage, entry);
+			}
+
+			// Keeps the shader alive with the builder, for builds that finish later
+			Builder& add_shader_stage(
+				const std::shared_ptr<Shader>& shader,
+				const vk::ShaderStageFlagBits stage,
+				const std::string_view entry = "main"
+			) {
+				add_shader_stage(*shader, stage, entry);
+				shaders.push_back(shader);
 				return *this;
 			}
 
@@ -226,6 +253,15 @@ namespace Vulxels::GFX {
 
 			Builder& add_descriptor_set_layout(const vk::DescriptorSetLayout layout) {
 				descriptor_set_layouts.push_back(layout);
+				descriptor_set_layout_hashes.push_back(hash_value(static_cast<VkDescriptorSetLayout>(layout)));
+				return *this;
+			}
+
+			// Keyed on the layout's bindings rather than its handle, which the driver
+			// may hand out again once the layout is destroyed
+			Builder& add_descriptor_set_layout(DescriptorLayout& layout) {
+				add_descriptor_set_layout(*layout.layout());
+				descriptor_set_layout_hashes.back() = layout.hash();
 				return *this;
 			}
 
@@ -234,8 +270,28 @@ namespace Vulxels::GFX {
 				return *this;
 			}
 
-			Builder& set_render_pass(const std::shared_ptr<vk::raii::RenderPass>& pass) {
+			// The pipeline is keyed on the pass's attachment formats rather than its
+			// handle, so they must be the ones it was created with
+			Builder& set_render_pass(
+				const std::shared_ptr<vk::raii::RenderPass>& pass,
+				const std::vector<vk::Format>& colors,
+				const vk::Format depth = vk::Format::eUndefined
+			) {
 				render_pass = pass;
+				color_formats = colors;
+				depth_format = depth;
+				return *this;
+			}
+
+			// For dynamic rendering, the pipeline is built against these formats
+			// instead of a render pass
+			Builder& set_attachment_formats(
+				const std::vector<vk::Format>& colors,
+				const vk::Format depth = vk::Format::eUndefined
+			) {
+				color_formats = colors;
+				depth_format = depth;
+				render_pass.reset();
 				return *this;
 			}
 
@@ -245,7 +301,12 @@ namespace Vulxels::GFX {
 				return Pipeline(m_device, *this);
 			}
 
+			// Hash of all state that affects the compiled pipeline
+			u64 hash() const;
+
 			std::vector<vk::PipelineShaderStageCreateInfo> shader_stages;
+			std::vector<u64> shader_hashes;
+			std::vector<std::shared_ptr<Shader>> shaders;
 			std::vector<vk::VertexInputBindingDescription> vertex_bindings;
 			std::vector<vk::VertexInputAttributeDescription> vertex_attributes;
 			vk::PipelineVertexInputStateCreateInfo vertex_input_state;
@@ -259,8 +320,11 @@ namespace Vulxels::GFX {
 			std::vector<vk::DynamicState> dynamic_states;
 			vk::PipelineDynamicStateCreateInfo dynamic_state;
 			std::vector<vk::DescriptorSetLayout> descriptor_set_layouts;
+			std::vector<u64> descriptor_set_layout_hashes;
 			std::vector<vk::PushConstantRange> push_constant_ranges;
 			std::shared_ptr<vk::raii::RenderPass> render_pass;
+			std::vector<vk::Format> color_formats;
+			vk::Format depth_format = vk::Format::eUndefined;
 
 		  private:
 			Device& m_device;
@@ -273,7 +337,7 @@ namespace Vulxels::GFX {
 		Pipeline& operator=(const Pipeline&) = delete;
 
 		vk::raii::PipelineLayout& layout() {
-			return m_layout;
+			return *m_layout;
 		}
 
 		vk::raii::Pipeline& pipeline() {
@@ -281,7 +345,7 @@ namespace Vulxels::GFX {
 		}
 
 	  private:
-		vk::raii::PipelineLayout m_layout = nullptr;
+		std::shared_ptr<vk::raii::PipelineLayout> m_layout;
 		vk::raii::Pipeline m_pipeline = nullptr;
 	};
 } // namespace Vulxels::GFX
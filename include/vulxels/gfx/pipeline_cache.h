@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class Device;
+
+	class PipelineCache {
+	  public:
+		explicit PipelineCache(Device& device);
+		~PipelineCache();
+
+		PipelineCache(const PipelineCache&) = delete;
+		PipelineCache& operator=(const PipelineCache&) = delete;
+
+		vk::raii::PipelineCache& cache() {
+			return m_cache;
+		}
+
+		const std::string& path() const {
+			return m_path;
+		}
+
+		// Returns an existing layout when one was already created from descriptor set
+		// layouts with the same hashes and the same push constant ranges
+		std::shared_ptr<vk::raii::PipelineLayout> layout(
+			std::span<const vk::DescriptorSetLayout> set_layouts,
+			std::span<const u64> set_layout_hashes,
+			std::span<const vk::PushConstantRange> push_constants
+		);
+
+		void save() const;
+
+	  private:
+		struct LayoutEntry {
+			std::vector<u64> set_layout_hashes;
+			std::vector<vk::PushConstantRange> push_constants;
+			std::shared_ptr<vk::raii::PipelineLayout> layout;
+		};
+
+		Device& m_device;
+		std::string m_path;
+		vk::raii::PipelineCache m_cache = nullptr;
+		std::unordered_map<u64, std::vector<LayoutEntry>> m_layouts;
+		std::mutex m_mutex;
+
+		std::vector<u8> load() const;
+	};
+} // namespace Vulxels::GFX
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/device.h>
+#include <vulxels/gfx/pipeline.h>
+#include <vulxels/job_system.h>
+#include <vulxels/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Vulxels::GFX {
+	// Shares pipelines between identical builder states. They're keyed on the
+	// builder's 64-bit hash alone, a collision would hand back the wrong pipeline
+	// but is accepted as vanishingly unlikely for the few hundred a run creates.
+	class PipelineLibrary {
+	  public:
+		class Handle {
+		  public:
+			Handle() = default;
+			explicit Handle(std::shared_future<std::shared_ptr<Pipeline>> future) : m_future(std::move(future)) {}
+
+			bool ready() const {
+				return m_future.valid() && m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+			}
+
+			// Never blocks, returns nullptr while the pipeline is still compiling or
+			// when it failed to
+			std::shared_ptr<Pipeline> get() const {
+				return ready() ? m_future.get() : nullptr;
+			}
+
+			bool failed() const {
+				return ready() && !m_future.get();
+			}
+
+			// Returns nullptr if the compile failed
+			std::shared_ptr<Pipeline> wait() const {
+				return m_future.get();
+			}
+
+		  private:
+			std::shared_future<std::shared_ptr<Pipeline>> m_future;
+		};
+
+		PipelineLibrary(Device& device, JobSystem& jobs) : m_device(device), m_jobs(jobs) {}
+		~PipelineLibrary() = default;
+
+		PipelineLibrary(const PipelineLibrary&) = delete;
+		PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+		// Throws if the pipeline fails to compile, and the next call tries again
+		std::shared_ptr<Pipeline> get(Pipeline::Builder& builder);
+
+		// Compiles on the worker pool, the builder is moved into the job. A failed
+		// compile is logged and leaves the handle null, and the next call tries again.
+		Handle get_async(Pipeline::Builder&& builder);
+
+		u64 hits() const {
+			return m_hits;
+		}
+
+		u64 misses() const {
+			return m_misses;
+		}
+
+		u32 pending() const {
+			return m_pending;
+		}
+
+		usize size() const {
+			std::lock_guard lock(m_mutex);
+			return m_pipelines.size();
+		}
+
+		void clear() {
+			std::lock_guard lock(m_mutex);
+			m_pipelines.clear();
+		}
+
+	  private:
+		Device& m_device;
+		JobSystem& m_jobs;
+		std::unordered_map<u64, std::shared_future<std::shared_ptr<Pipeline>>> m_pipelines;
+		std::atomic<u64> m_hits = 0;
+		std::atomic<u64> m_misses = 0;
+		std::atomic<u32> m_pending = 0;
+		mutable std::mutex m_mutex;
+
+		void evict(u64 hash);
+	};
+} // namespace Vulxels::GFX
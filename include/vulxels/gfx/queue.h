@@ -8,18 +8,28 @@
 
 #include <vulxels/types.h>
 
-#include <tuple>
+#include <memory>
+#include <mutex>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace Vulxels::GFX {
 	class Device;
+
+	struct QueueFamilies {
+		u32 graphics;
+		u32 present; // Same as graphics when there is no surface
+		u32 transfer; // Same as graphics when there is no dedicated transfer family
+		u32 compute; // Same as graphics when there is no family with compute but not graphics
+	};
+
 	class Queue {
 	  public:
-		static std::tuple<u32, u32>
-		find_families(const vk::raii::PhysicalDevice& device, const vk::raii::SurfaceKHR& surface);
+		// The surface may be null for headless devices
+		static QueueFamilies find_families(const vk::raii::PhysicalDevice& device, const vk::raii::SurfaceKHR& surface);
 
 		Queue() = default;
-		Queue(Device& device, u32 index);
+		// Queues of the same family are the same VkQueue, so they share `mutex`
+		Queue(Device& device, u32 index, std::shared_ptr<std::mutex> mutex);
 		~Queue() = default;
 
 		Queue(const Queue&) = delete;
@@ -35,20 +45,25 @@ namespace Vulxels::GFX {
 			return m_index;
 		}
 
+		// Vulkan needs queue access externally synchronised, and any thread may submit
 		void wait_idle() const {
+			std::lock_guard lock(*m_mutex);
 			m_queue.waitIdle();
 		}
 
 		void submit(const vk::SubmitInfo& info, const vk::Fence fence = {}) const {
+			std::lock_guard lock(*m_mutex);
 			m_queue.submit(info, fence);
 		}
 
 		vk::Result present(const vk::PresentInfoKHR& info) const {
+			std::lock_guard lock(*m_mutex);
 			return m_queue.presentKHR(info);
 		}
 
 	  private:
 		vk::raii::Queue m_queue = nullptr;
 		u32 m_index;
+		std::shared_ptr<std::mutex> m_mutex;
 	};
 } // namespace Vulxels::GFX
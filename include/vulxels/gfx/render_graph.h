@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/allocator.h>
+#include <vulxels/types.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class Renderer;
+
+	// Passes are declared every frame along with the images they read and write.
+	// Executing the graph culls passes whose results nobody uses, inserts the
+	// barriers and layout transitions between the rest, and backs transient
+	// images with memory shared between those whose lifetimes don't overlap.
+	// Each pass is timed with the renderer's GPU profiler.
+	class RenderGraph {
+	  public:
+		static constexpr u32 INVALID_INDEX = ~0u;
+
+		struct Handle {
+			u32 index = INVALID_INDEX;
+
+			bool valid() const {
+				return index != INVALID_INDEX;
+			}
+		};
+
+		struct ImageDesc {
+			vk::Format format = vk::Format::eUndefined;
+			vk::Extent2D extent {}; // zero follows the swapchain
+		};
+
+		// An image owned elsewhere, left in `final_layout` once the graph is done
+		struct ImportedImage {
+			vk::Image image;
+			vk::ImageView view;
+			vk::Format format;
+			vk::Extent2D extent;
+			vk::ImageLayout initial_layout = vk::ImageLayout::eUndefined;
+			vk::ImageLayout final_layout = vk::ImageLayout::eUndefined; // undefined leaves it as last used
+			vk::PipelineStageFlags initial_stages = vk::PipelineStageFlagBits::eTopOfPipe; // e.g. a semaphore wait
+		};
+
+		struct PassContext {
+			const vk::raii::CommandBuffer& cmd;
+			// For secondary buffers in graphics passes, chains the rendering info
+			// with dynamic rendering so it's only valid during the call
+			vk::CommandBufferInheritanceInfo inheritance;
+			vk::Extent2D extent;
+		};
+
+		using ExecuteFunc = std::function<void(const PassContext& context)>;
+
+		// Declares what a pass touches, passes with attachments are graphics passes
+		// and are run inside a render pass with the viewport and scissor set
+		class PassBuilder {
+		  public:
+			PassBuilder& write_color(Handle image, std::optional<vk::ClearColorValue> clear = std::nullopt);
+			PassBuilder& write_depth(Handle image, std::optional<f32> clear = std::nullopt);
+			PassBuilder& read(Handle image, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eFragmentShader);
+			PassBuilder&
+			read_storage(Handle image, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eComputeShader);
+			PassBuilder&
+			write_storage(Handle image, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eComputeShader);
+			PassBuilder& copy_from(Handle image);
+			PassBuilder& copy_to(Handle image);
+
+			// Never culled, for passes whose effects the graph can't see
+			PassBuilder& side_effect();
+
+			// The render pass is begun for secondary buffers, the pass records them
+			// with the context's inheritance info and executes them itself
+			PassBuilder& use_secondary_buffers();
+
+		  private:
+			friend class RenderGraph;
+			PassBuilder(RenderGraph& graph, const u32 pass) : m_graph(graph), m_pass(pass) {}
+
+			RenderGraph& m_graph;
+			u32 m_pass;
+		};
+
+		struct Stats {
+			u32 passes = 0;
+			u32 culled = 0;
+			u32 transient_images = 0;
+			u32 allocations = 0;
+			vk::DeviceSize memory = 0; // backing the transient images
+			vk::DeviceSize unaliased_memory = 0; // had none of them shared
+		};
+
+		explicit RenderGraph(Renderer& renderer);
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		// Clears the previous frame's declarations, handles from it are invalid
+		void reset();
+
+		Handle create_image(std::string_view name, const ImageDesc& desc);
+		Handle import_image(std::string_view name, const ImportedImage& image);
+		// The swapchain image being rendered this frame
+		Handle import_backbuffer();
+
+		PassBuilder add_pass(std::string_view name, ExecuteFunc execute);
+
+		// Records every live pass into the frame's primary command buffer
+		void execute(const vk::raii::CommandBuffer& cmd);
+
+		// Only valid while the graph is executing
+		vk::Image image(Handle handle) const;
+		vk::ImageView view(Handle handle) const;
+
+		// Graphics passes use dynamic rendering when the device has it, pipelines
+		// are then built with attachment formats instead of a render pass
+		bool dynamic_rendering() const;
+
+		// A render pass compatible with the ones the graph creates for these
+		// attachments, for building pipelines against without dynamic rendering
+		std::shared_ptr<vk::raii::RenderPass>
+		compatible_render_pass(const std::vector<vk::Format>& colors, vk::Format depth = vk::Format::eUndefined);
+
+		const Stats& stats() const {
+			return m_stats;
+		}
+
+	  private:
+		enum class Usage : u8 {
+			Color,
+			Depth,
+			Sampled,
+			StorageRead,
+			StorageWrite,
+			TransferSrc,
+			TransferDst,
+		};
+
+		struct State {
+			vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+			vk::PipelineStageFlags stages;
+			vk::AccessFlags access;
+		};
+
+		struct Access {
+			u32 resource;
+			Usage usage;
+			vk::PipelineStageFlags stages;
+			std::optional<vk::ClearValue> clear;
+		};
+
+		struct Pass {
+			std::string name;
+			ExecuteFunc execute;
+			std::vector<Access> accesses;
+			bool side_effect = false;
+			bool secondary = false;
+			bool culled = false;
+		};
+
+		struct Resource {
+			std::string name;
+			ImageDesc desc;
+			vk::ImageUsageFlags usage;
+			bool imported = false;
+			ImportedImage import;
+			u32 first = INVALID_INDEX; // live passes using it
+			u32 last = INVALID_INDEX;
+			u32 physical = INVALID_INDEX;
+			State state;
+		};
+
+		// A transient image and the memory it lives in, kept between frames while
+		// the graph keeps the same shape
+		struct Physical {
+			vk::raii::Image image = nullptr;
+			vk::raii::ImageView view = nullptr;
+			vk::MemoryRequirements requirements;
+			u32 slot = INVALID_INDEX;
+		};
+
+		struct Slot {
+			Allocation memory;
+			vk::DeviceSize size = 0;
+			vk::DeviceSize alignment = 1;
+			u32 memory_types = ~0u;
+			u32 last = 0;
+			State state; // last use by any image in it, carried across frames
+		};
+
+		struct Barriers {
+			std::vector<vk::ImageMemoryBarrier> images;
+			vk::PipelineStageFlags src;
+			vk::PipelineStageFlags dst;
+		};
+
+		struct AttachmentKey {
+			vk::Format format;
+			vk::AttachmentLoadOp load;
+			vk::AttachmentStoreOp store;
+
+			auto operator<=>(const AttachmentKey&) const = default;
+		};
+
+		// Replaced images and framebuffers, handed to the renderer to destroy once
+		// the frames using them finish. Declared so images go before their memory.
+		struct Retired {
+			std::vector<Slot> slots;
+			std::vector<Physical> physical;
+			std::map<std::vector<u64>, vk::raii::Framebuffer> framebuffers;
+		};
+
+		Renderer& m_renderer;
+		std::vector<Pass> m_passes;
+		std::vector<Resource> m_resources;
+		Stats m_stats;
+
+		std::vector<u64> m_signature;
+		std::vector<Slot> m_slots;
+		std::vector<Physical> m_physical;
+		std::map<std::vector<AttachmentKey>, std::shared_ptr<vk::raii::RenderPass>> m_render_passes;
+		std::map<std::vector<u64>, vk::raii::Framebuffer> m_framebuffers;
+		u64 m_swapchain_generation = 0;
+
+		void add_access(
+			u32 pass,
+			Handle image,
+			Usage usage,
+			vk::PipelineStageFlags stages,
+			std::optional<vk::ClearValue> clear = std::nullopt
+		);
+		void cull();
+		void allocate_transients();
+		void execute_pass(const vk::raii::CommandBuffer& cmd, Pass& pass, u32 index);
+		void transition(Resource& resource, const State& next, Barriers& barriers);
+		void flush(const vk::raii::CommandBuffer& cmd, Barriers& barriers) const;
+		void retire(bool transients);
+
+		std::shared_ptr<vk::raii::RenderPass> render_pass(const std::vector<AttachmentKey>& attachments);
+		vk::raii::Framebuffer&
+		framebuffer(const vk::raii::RenderPass& pass, const std::vector<vk::ImageView>& views, vk::Extent2D extent);
+	};
+} // namespace Vulxels::GFX
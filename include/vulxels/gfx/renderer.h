@@ -6,24 +6,69 @@
 
 #pragma once
 
+#include <vulxels/gfx/bindless.h>
+#include <vulxels/gfx/buffer.h>
+#include <vulxels/gfx/command_pool.h>
+#include <vulxels/gfx/descriptors.h>
 #include <vulxels/gfx/device.h>
+#include <vulxels/gfx/gpu_profiler.h>
 #include <vulxels/gfx/instance.h>
 #include <vulxels/gfx/pipeline.h>
+#include <vulxels/gfx/pipeline_library.h>
 #include <vulxels/gfx/shader.h>
 #include <vulxels/gfx/swapchain.h>
 #include <vulxels/gfx/window.h>
+#include <vulxels/job_system.h>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Vulxels::GFX {
+	struct RendererConfig {
+		u32 frames_in_flight = 2; // 1 to Renderer::MAX_FRAMES_IN_FLIGHT
+		vk::PresentModeKHR present_mode = vk::PresentModeKHR::eMailbox; // falls back to FIFO
+		u32 image_count = 0; // 0 picks one more than the surface minimum
+		f32 frame_limit = 0.0f; // frames per second, 0 for no limit
+		std::string device; // index or part of the name, only read when the renderer is created
+	};
+
 	class Renderer {
 	  public:
-		static constexpr u32 MAX_FRAMES_IN_FLIGHT = 2;
+		// Per-frame resources are created for this many frames up front, the
+		// config decides how many of them are cycled through
+		static constexpr u32 MAX_FRAMES_IN_FLIGHT = 4;
+		static_assert(Swapchain::MIN_OFFSCREEN_IMAGES >= MAX_FRAMES_IN_FLIGHT);
 
-		explicit Renderer(Window& window);
+		// Fewer items than this per batch aren't worth handing to another thread
+		static constexpr usize DEFAULT_MIN_BATCH = 256;
+
+		using RecordFunc = std::function<void(const vk::raii::CommandBuffer& cmd, usize begin, usize end)>;
+
+		explicit Renderer(Window& window, const RendererConfig& config = {});
+		// Headless, renders offscreen without a window, surface or present queue
+		explicit Renderer(vk::Extent2D extent, const RendererConfig& config = {});
 		~Renderer();
 
 		Renderer(const Renderer&) = delete;
 		Renderer& operator=(const Renderer&) = delete;
 
+		// nullptr when headless
+		Window* window() {
+			return m_window;
+		}
+
 		Instance& instance() {
 			return m_instance;
 		}
@@ -44,19 +89,161 @@ namespace Vulxels::GFX {
 			return Pipeline::Builder(m_device);
 		}
 
+		PipelineLibrary& pipelines() {
+			return m_pipelines;
+		}
+
+		GpuProfiler& profiler() {
+			return m_profiler;
+		}
+
+		JobSystem& jobs() {
+			return m_jobs;
+		}
+
+		// Sets allocated from here are only valid until this frame slot comes around again
+		DescriptorAllocator& frame_descriptors() {
+			return m_frame_descriptors[m_current_frame];
+		}
+
+		const RendererConfig& config() const {
+			return m_config;
+		}
+
+		// Applied at the start of the next frame
+		void set_config(const RendererConfig& config);
+
+		// Call once the input the next frame reacts to has been polled, latency is
+		// measured from here, otherwise from the start of begin_frame()
+		void mark_input() {
+			m_input = Clock::now();
+		}
+
+		// Smoothed milliseconds from input being polled until the frame has been
+		// presented, or only until it finishes on the GPU without present wait.
+		// Starts over whenever the config changes or the swapchain is recreated.
+		f32 latency() const {
+			return m_latency;
+		}
+
+		// Whether latency() runs to present rather than to GPU completion
+		bool latency_to_present() const {
+			return m_device.features().present_wait;
+		}
+
+		bool headless() const {
+			return m_swapchain.headless();
+		}
+
+		// Copies the image of the frame being recorded into a PPM file once it has
+		// rendered, this waits for the frame so it's meant for tests and captures
+		void save_frame(const std::string& path);
+
+		// nullptr when the device lacks descriptor indexing
+		BindlessTable* bindless() {
+			return m_bindless.get();
+		}
+
+		// Secondary command buffer for the current frame, already begun to continue
+		// the render pass in `inheritance`. Any thread may call this between
+		// begin_frame() and end_frame(), each records into its own pool. The caller
+		// ends it and executes it from the frame's primary buffer.
+		vk::raii::CommandBuffer* begin_secondary(const vk::CommandBufferInheritanceInfo& inheritance);
+
+		// Splits [0, count) into batches of at least `min_batch` items and records
+		// them into secondary buffers on the workers, returned in batch order for
+		// executeCommands(). The render pass must have been begun for secondary
+		// buffers. `func` runs concurrently, so it mustn't touch the GPU profiler,
+		// name a `scope` to time the whole lot instead.
+		std::vector<vk::CommandBuffer> record_parallel(
+			const vk::CommandBufferInheritanceInfo& inheritance,
+			usize count,
+			const RecordFunc& func,
+			std::string_view scope = {},
+			usize min_batch = DEFAULT_MIN_BATCH
+		);
+
 		void handle_events(const SDL_Event& event);
 
+		// Takes ownership of a buffer, pipeline, image view, descriptor set or
+		// anything else the GPU may still be using and destroys it once every
+		// frame submitted so far, and the one being recorded, has finished. Any
+		// thread may call this.
+		template<typename T>
+		void defer_destroy(T&& object) {
+			auto held = std::make_shared<std::decay_t<T>>(std::forward<T>(object));
+			std::lock_guard lock(m_deferred_mutex);
+			m_deferred_pending.push_back(std::move(held));
+		}
+
+		// Binds the pipeline if it has finished compiling, otherwise the fallback,
+		// returns false when neither is available and the draw should be skipped
+		bool bind_pipeline(
+			const vk::raii::CommandBuffer& cmd,
+			const PipelineLibrary::Handle& handle,
+			const std::shared_ptr<Pipeline>& fallback = nullptr
+		) const;
+
 	  private:
-		Window& m_window;
+		using Clock = std::chrono::steady_clock;
+
+		Window* m_window;
+		RendererConfig m_config;
+		std::optional<RendererConfig> m_pending_config;
 		Instance m_instance;
-		Device m_device {m_instance, m_window};
-		Swapchain m_swapchain {m_device, m_window};
+		Device m_device;
+		Swapchain m_swapchain;
+		GpuProfiler m_profiler {m_device, MAX_FRAMES_IN_FLIGHT};
+		JobSystem m_jobs; // Shut down first thing in the destructor, jobs use everything below
+		PipelineLibrary m_pipelines {m_device, m_jobs};
 
 		u32 m_current_frame = 0;
 		vk::raii::CommandBuffers m_commands = nullptr;
 		std::vector<vk::raii::Fence> m_frame_ready;
 		std::vector<vk::raii::Semaphore> m_image_available;
 		std::vector<vk::raii::Semaphore> m_render_finished;
+		std::vector<DescriptorAllocator> m_frame_descriptors;
+		std::unique_ptr<BindlessTable> m_bindless;
+
+		// Secondary buffers are recycled by frame number, a frame is known to have
+		// completed once its slot's fence has been waited on
+		std::unordered_map<std::thread::id, std::unique_ptr<CommandPool>> m_secondary_pools;
+		std::mutex m_secondary_mutex;
+		std::array<u64, MAX_FRAMES_IN_FLIGHT> m_slot_frame {};
+		u64 m_frame_number = 0;
+		u64 m_frame_completed = 0;
+
+		// Pending objects are stamped with the next frame submitted and destroyed
+		// once it has completed
+		std::vector<std::shared_ptr<void>> m_deferred_pending;
+		std::deque<std::pair<u64, std::vector<std::shared_ptr<void>>>> m_deferred;
+		std::mutex m_deferred_mutex;
+
+		// Submitted frames waiting to be presented or finish, oldest first
+		struct LatencySample {
+			u64 frame;
+			Clock::time_point input;
+		};
+
+		std::optional<Clock::time_point> m_input;
+		Clock::time_point m_frame_input;
+		std::deque<LatencySample> m_latency_samples;
+		u64 m_latency_generation = 0;
+		Clock::time_point m_next_frame;
+		f32 m_latency = 0.0f;
+
+		std::string m_save_path;
+		std::unique_ptr<Buffer> m_readback;
+
+		void init();
+		void apply_config(const RendererConfig& config);
+		void poll_latency();
+		void reset_latency();
+		bool frame_finished(u64 frame) const;
+		void limit_frame_rate();
+		void release_deferred();
+		void record_readback(const vk::raii::CommandBuffer& cmd);
+		void write_readback();
 
 	  public:
 		// TODO: make these private
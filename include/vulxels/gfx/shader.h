@@ -30,8 +30,14 @@ namespace Vulxels::GFX {
 			return m_module;
 		}
 
+		// Hash of the SPIR-V, stable across runs unlike the module handle
+		u64 hash() const {
+			return m_hash;
+		}
+
 	  private:
 		Device& m_device;
 		vk::raii::ShaderModule m_module = nullptr;
+		u64 m_hash = 0;
 	};
 } // namespace Vulxels::GFX
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/gfx/buffer.h>
+#include <vulxels/gfx/command_pool.h>
+#include <vulxels/gfx/device.h>
+#include <vulxels/gfx/timeline.h>
+#include <vulxels/types.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class StagingRing {
+	  public:
+		static constexpr vk::DeviceSize DEFAULT_CAPACITY = 32 * 1024 * 1024;
+		static constexpr vk::DeviceSize ALIGNMENT = 16;
+
+		explicit StagingRing(Device& device, vk::DeviceSize capacity = DEFAULT_CAPACITY);
+		~StagingRing();
+
+		StagingRing(const StagingRing&) = delete;
+		StagingRing& operator=(const StagingRing&) = delete;
+
+		vk::DeviceSize capacity() const {
+			return m_capacity;
+		}
+
+		Timeline& timeline() {
+			return m_timeline;
+		}
+
+		// Returns space for `size` bytes that stays valid until it's passed to copy()
+		// or release(), the offset is relative to the staging buffer
+		void* reserve(vk::DeviceSize size, vk::DeviceSize& offset);
+		void release(vk::DeviceSize offset);
+
+		// Both return the timeline value the copy will have completed at
+		u64 copy(vk::Buffer dst, vk::DeviceSize src_offset, vk::DeviceSize dst_offset, vk::DeviceSize size);
+		u64 upload(vk::Buffer dst, const void* data, vk::DeviceSize size, vk::DeviceSize dst_offset = 0);
+
+		// Drops copies into `dst` that haven't been flushed, for a buffer being destroyed
+		void cancel(vk::Buffer dst);
+
+		// Records every queued copy into a single command buffer and submits it to
+		// the transfer queue, returns the timeline value that signals completion
+		u64 flush();
+		void wait_idle();
+
+	  private:
+		struct Copy {
+			vk::Buffer dst;
+			vk::BufferCopy region;
+		};
+
+		struct Submission {
+			u64 value = 0;
+			u64 end = 0;
+		};
+
+		struct Reservation {
+			vk::DeviceSize offset;
+			u64 start;
+		};
+
+		Device& m_device;
+		Timeline m_timeline;
+		Buffer m_buffer;
+		u8* m_mapped;
+		vk::DeviceSize m_capacity;
+
+		// Monotonic byte positions, wrapped modulo capacity when addressing the buffer
+		u64 m_head = 0;
+		u64 m_tail = 0;
+
+		CommandPool m_pool;
+		std::vector<Copy> m_pending;
+		std::vector<Reservation> m_open; // reserved but not yet copied, the tail can't pass them
+		std::deque<Submission> m_in_flight;
+		std::mutex m_mutex;
+
+		void* reserve_locked(vk::DeviceSize size, vk::DeviceSize& offset);
+		void close(vk::DeviceSize offset);
+		u64 flush_locked();
+		void reclaim(bool wait);
+	};
+} // namespace Vulxels::GFX
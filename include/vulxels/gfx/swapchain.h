@@ -6,18 +6,31 @@
 
 #pragma once
 
+#include <vulxels/gfx/allocator.h>
 #include <vulxels/gfx/device.h>
 #include <vulxels/gfx/window.h>
 
+#include <deque>
 #include <limits>
-#include <memory>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
 namespace Vulxels::GFX {
 	class Swapchain {
 	  public:
-		Swapchain(Device& device, Window& window);
+		// Offscreen images are never shared between frames, so there are at least
+		// as many as Renderer::MAX_FRAMES_IN_FLIGHT
+		static constexpr u32 MIN_OFFSCREEN_IMAGES = 4;
+
+		// A zero image count picks one more than the surface minimum
+		Swapchain(
+			Device& device,
+			Window& window,
+			vk::PresentModeKHR preferred_mode = vk::PresentModeKHR::eMailbox,
+			u32 preferred_image_count = 0
+		);
+		// Headless, renders into offscreen images that are never presented
+		Swapchain(Device& device, vk::Extent2D extent, u32 image_count = 0);
 		~Swapchain() = default;
 
 		Swapchain(const Swapchain&) = delete;
@@ -27,11 +40,38 @@ namespace Vulxels::GFX {
 			return m_swapchain;
 		}
 
-		vk::raii::Framebuffer& framebuffer(u32 index = -1) {
+		vk::Image image(u32 index = -1) const {
 			if (index == std::numeric_limits<u32>::max()) {
 				index = m_current_image;
 			}
-			return m_framebuffers[index];
+			return m_images[index];
+		}
+
+		vk::ImageView image_view(u32 index = -1) const {
+			if (index == std::numeric_limits<u32>::max()) {
+				index = m_current_image;
+			}
+			return *m_image_views[index];
+		}
+
+		// Changes whenever the images are recreated, so anything holding on to
+		// their views knows to let go
+		u64 generation() const {
+			return m_generation;
+		}
+
+		bool headless() const {
+			return m_window == nullptr;
+		}
+
+		// Layout render passes should leave the image in at the end of a frame
+		vk::ImageLayout final_layout() const {
+			return headless() ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+		}
+
+		// Whether the images can be copied from, always true when headless
+		bool can_read_back() const {
+			return static_cast<bool>(m_usage & vk::ImageUsageFlagBits::eTransferSrc);
 		}
 
 		vk::SurfaceFormatKHR format() const {
@@ -58,35 +98,66 @@ namespace Vulxels::GFX {
 			return m_current_image;
 		}
 
-		void set_render_pass(const std::shared_ptr<vk::raii::RenderPass>& pass);
 		void set_resized();
-		bool acquire(const vk::raii::Semaphore& signal);
-		bool present(const vk::raii::Semaphore& wait);
+
+		// Both take effect when the swapchain is next recreated, which happens
+		// after the next present
+		void set_present_mode(vk::PresentModeKHR mode);
+		void set_image_count(u32 count);
+
+		// Recreating doesn't wait for the device, whatever is replaced is kept
+		// until the frames that could be using it have finished. `completed` is
+		// the newest frame known to be done and `frame` the one being presented.
+		bool acquire(const vk::raii::Semaphore& signal, u64 completed);
+		bool present(const vk::raii::Semaphore& wait, u64 frame);
+
+		// Whether the image presented with `frame` has reached the screen, only
+		// with DeviceFeatures::present_wait and until the swapchain is recreated
+		bool presented(u64 frame) const;
 
 	  private:
+		// Declared so views go before their images and images before their memory
+		struct Retired {
+			std::vector<vk::raii::SwapchainKHR> swapchains;
+			std::vector<Allocation> offscreen_memory;
+			std::vector<vk::raii::Image> offscreen_images;
+			std::vector<vk::raii::ImageView> image_views;
+			u64 frame = 0;
+		};
+
 		Device& m_device;
-		Window& m_window;
+		Window* m_window = nullptr;
 
 		vk::raii::SwapchainKHR m_swapchain = nullptr;
+		std::vector<Allocation> m_offscreen_memory;
+		std::vector<vk::raii::Image> m_offscreen_images;
 		std::vector<vk::Image> m_images;
 		std::vector<vk::raii::ImageView> m_image_views;
-		std::vector<vk::raii::Framebuffer> m_framebuffers;
-		std::shared_ptr<vk::raii::RenderPass> m_render_pass;
+		std::deque<Retired> m_retired;
+		u64 m_frame = 0; // last presented
+
+		vk::PresentModeKHR m_preferred_mode;
+		u32 m_preferred_image_count;
+		bool m_settings_changed = false;
 
+		vk::ImageUsageFlags m_usage = vk::ImageUsageFlagBits::eColorAttachment;
 		vk::SurfaceFormatKHR m_format;
 		vk::PresentModeKHR m_present_mode;
 		vk::Extent2D m_extent;
 		u32 m_image_count;
-		u32 m_current_image;
+		u32 m_current_image = 0;
+		u64 m_generation = 0;
 		bool m_resized = false;
 
 		void recreate();
+		Retired& retire();
+		void release_retired(u64 completed);
 		void create_swapchain();
+		void create_offscreen_images();
 		void create_image_views();
-		void create_framebuffers();
 
 		void choose_format(std::vector<vk::SurfaceFormatKHR>& formats);
-		void choose_present_mode(std::vector<vk::PresentModeKHR>& modes);
+		void choose_present_mode(const std::vector<vk::PresentModeKHR>& modes);
 		void choose_image_count(const vk::SurfaceCapabilitiesKHR& capabilities);
 		bool choose_extent(const vk::SurfaceCapabilitiesKHR& capabilities);
 	};
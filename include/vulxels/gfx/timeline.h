@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <limits>
+#include <vulkan/vulkan_raii.hpp>
+
+namespace Vulxels::GFX {
+	class Device;
+
+	class Timeline {
+	  public:
+		explicit Timeline(Device& device);
+		~Timeline() = default;
+
+		Timeline(const Timeline&) = delete;
+		Timeline& operator=(const Timeline&) = delete;
+
+		vk::raii::Semaphore& semaphore() {
+			return m_semaphore;
+		}
+
+		// The most recent value handed out for a submission to signal
+		u64 value() const {
+			return m_value;
+		}
+
+		u64 next() {
+			return ++m_value;
+		}
+
+		u64 completed() const {
+			return m_semaphore.getCounterValue();
+		}
+
+		bool is_complete(const u64 value) const {
+			return completed() >= value;
+		}
+
+		bool wait(u64 value, u64 timeout = std::numeric_limits<u64>::max()) const;
+
+	  private:
+		Device& m_device;
+		vk::raii::Semaphore m_semaphore = nullptr;
+		u64 m_value = 0;
+	};
+} // namespace Vulxels::GFX
@@ -0,0 +1,37 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <span>
+#include <type_traits>
+
+namespace Vulxels {
+	inline constexpr u64 FNV_OFFSET = 0xcbf29ce484222325;
+	inline constexpr u64 FNV_PRIME = 0x100000001b3;
+
+	inline u64 hash_bytes(const void* data, const usize size, u64 seed = FNV_OFFSET) {
+		const auto bytes = static_cast<const u8*>(data);
+		for (usize i = 0; i < size; i++) {
+			seed = (seed ^ bytes[i]) * FNV_PRIME;
+		}
+		return seed;
+	}
+
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	u64 hash_value(const T& value, const u64 seed = FNV_OFFSET) {
+		return hash_bytes(&value, sizeof(T), seed);
+	}
+
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	u64 hash_span(const std::span<const T> values, const u64 seed = FNV_OFFSET) {
+		return hash_bytes(values.data(), values.size_bytes(), hash_value(values.size(), seed));
+	}
+} // namespace Vulxels
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Vulxels {
+	// A worker per core, each pinned to it and with deques of its own. Workers take
+	// their newest job first and steal the oldest from each other when they run
+	// dry, so related work stays on one core. Jobs are counted on counters that
+	// can be waited on, or that other jobs can be held back until are done, and a
+	// thread waiting on one runs jobs itself rather than blocking.
+	class JobSystem {
+	  public:
+		// Every urgent job is taken before any normal one, and so on
+		enum class Priority : u8 {
+			High, // needed this frame, e.g. recording commands
+			Normal,
+			Low, // background work, e.g. generating and meshing chunks
+		};
+		static constexpr usize PRIORITIES = 3;
+
+		// How often stats() measures utilisation
+		static constexpr std::chrono::milliseconds STATS_INTERVAL {250};
+
+		class Counter;
+
+		struct Job {
+			std::function<void()> func;
+			Priority priority = Priority::Normal;
+			Counter* counter = nullptr;
+		};
+
+		// Jobs not yet finished. Wait on a counter before destroying it, and only add
+		// more jobs to it once anything held back until it's done has started.
+		class Counter {
+		  public:
+			Counter() = default;
+			~Counter() = default;
+
+			Counter(const Counter&) = delete;
+			Counter& operator=(const Counter&) = delete;
+
+			bool done() const {
+				return m_pending.load(std::memory_order_acquire) == 0;
+			}
+
+			u32 pending() const {
+				return m_pending.load(std::memory_order_relaxed);
+			}
+
+		  private:
+			std::atomic<u32> m_pending = 0;
+			std::mutex m_mutex;
+			std::condition_variable m_cv;
+			std::vector<Job> m_held; // started once nothing is pending
+
+			friend class JobSystem;
+		};
+
+		struct WorkerStats {
+			f32 utilisation = 0.0f; // of the last interval, spent running jobs
+			u64 jobs = 0;
+			u64 stolen = 0; // of those, taken from another worker
+		};
+
+		explicit JobSystem(usize threads = default_thread_count());
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		usize size() const {
+			return m_workers.size();
+		}
+
+		// Counted on `counter` until it finishes, and not started until `after` is done
+		void run(
+			std::function<void()> func,
+			Priority priority = Priority::Normal,
+			Counter* counter = nullptr,
+			Counter* after = nullptr
+		);
+
+		template<typename F>
+		std::future<std::invoke_result_t<F>> submit(F&& func, const Priority priority = Priority::Normal) {
+			using R = std::invoke_result_t<F>;
+			auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+			auto future = task->get_future();
+			run([task] { (*task)(); }, priority);
+			return future;
+		}
+
+		// Runs jobs of `priority` or more urgent on this thread until the counter is
+		// done, sleeping only when there are none left to take
+		void wait(Counter& counter, Priority priority = Priority::Low);
+
+		// Runs every queued job, and any they release, then joins the workers. Jobs
+		// added afterwards never run. Called by the destructor if not before.
+		void shutdown();
+
+		// Measured at most every STATS_INTERVAL, returns the last measurement otherwise
+		std::vector<WorkerStats> stats();
+
+		static usize default_thread_count() {
+			const usize count = std::thread::hardware_concurrency();
+			return count > 1 ? count - 1 : 1;
+		}
+
+	  private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Worker {
+			std::thread thread;
+			std::mutex mutex;
+			std::array<std::deque<Job>, PRIORITIES> queues;
+			std::atomic<u64> busy_ns = 0;
+			std::atomic<u64> jobs = 0;
+			std::atomic<u64> stolen = 0;
+		};
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::atomic<usize> m_next = 0; // round robin for jobs from other threads
+		std::atomic<usize> m_queued = 0;
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_sleep_cv;
+		bool m_stopping = false;
+
+		std::mutex m_stats_mutex;
+		Clock::time_point m_stats_time = Clock::now();
+		std::vector<u64> m_stats_busy;
+		std::vector<WorkerStats> m_stats;
+
+		void worker(usize index);
+		void enqueue(Job&& job);
+		bool take(usize index, Priority lowest, Job& job);
+		void execute(usize index, Job& job);
+		void finish(Counter& counter);
+	};
+} // namespace Vulxels
@@ -14,3 +14,15 @@
 #define VX_CRIT(...) spdlog::critical(__VA_ARGS__)
 #define VX_DEBUG(...) spdlog::debug(__VA_ARGS__)
 #define VX_TRACE(...) spdlog::trace(__VA_ARGS__)
+
+#ifdef VX_PROFILE
+	#include <vulxels/profiler.h>
+
+	#define VX_CONCAT_IMPL(a, b) a##b
+	#define VX_CONCAT(a, b) VX_CONCAT_IMPL(a, b)
+	#define VX_ZONE(name) ::Vulxels::Profiler::Zone VX_CONCAT(vx_zone_, __LINE__)(name)
+	#define VX_THREAD_NAME(name) ::Vulxels::Profiler::set_thread_name(name)
+#else
+	#define VX_ZONE(name) ((void)0)
+	#define VX_THREAD_NAME(name) ((void)0)
+#endif
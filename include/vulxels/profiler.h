@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <atomic>
+#include <string>
+#include <string_view>
+
+namespace Vulxels {
+	// CPU zone profiler, use through VX_ZONE in log.h so it compiles out when
+	// VX_PROFILE isn't defined. Zones are only recorded while a capture is
+	// running, each thread writes into its own ring without taking a lock.
+	class Profiler {
+	  public:
+		static constexpr u32 DEFAULT_CAPTURE_FRAMES = 300;
+
+		class Zone {
+		  public:
+			// The name must outlive the capture, string literals are expected
+			explicit Zone(const char* name) : m_name(name), m_start(capturing() ? now() : NOT_CAPTURED) {}
+			~Zone() {
+				if (m_start != NOT_CAPTURED) {
+					record(m_name, m_start, now());
+				}
+			}
+
+			Zone(const Zone&) = delete;
+			Zone& operator=(const Zone&) = delete;
+
+		  private:
+			static constexpr u64 NOT_CAPTURED = ~0ull;
+
+			const char* m_name;
+			u64 m_start;
+		};
+
+		// Records zones for the next `frames` frames and then writes them to
+		// `path` as Chrome trace JSON, viewable in chrome://tracing or Perfetto
+		static void capture(u32 frames = DEFAULT_CAPTURE_FRAMES, std::string path = "trace.json");
+
+		static bool capturing() {
+			return s_active.load(std::memory_order_relaxed);
+		}
+
+		// Call once per frame from the main thread, collects the rings and
+		// finishes the capture when its frames have elapsed
+		static void frame();
+
+		static void set_thread_name(std::string_view name);
+
+	  private:
+		static inline std::atomic<bool> s_active {false};
+
+		static u64 now();
+		static void record(const char* name, u64 start, u64 end);
+	};
+} // namespace Vulxels
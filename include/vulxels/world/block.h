@@ -0,0 +1,28 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+namespace Vulxels::World {
+	// Block types, the id doubles as the material index shaders look up
+	using BlockId = u16;
+
+	namespace Block {
+		inline constexpr BlockId Air = 0;
+		inline constexpr BlockId Stone = 1;
+		inline constexpr BlockId Dirt = 2;
+		inline constexpr BlockId Grass = 3;
+		inline constexpr BlockId Sand = 4;
+		inline constexpr BlockId Snow = 5;
+		inline constexpr BlockId Water = 6;
+	} // namespace Block
+
+	inline constexpr bool is_solid(const BlockId block) {
+		return block != Block::Air && block != Block::Water;
+	}
+} // namespace Vulxels::World
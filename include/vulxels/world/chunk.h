@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+#include <vulxels/world/block.h>
+
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace Vulxels::World {
+	// 32³ blocks stored as indices into a palette of the distinct blocks in the
+	// chunk. Indices are packed 0, 1, 2, 4, 8 or 16 bits wide so none straddle a
+	// word, widening as blocks are added and narrowing once enough are gone. A
+	// chunk of a single block, like all air or all stone, has no indices at all.
+	class Chunk {
+	  public:
+		static constexpr u32 SIZE_LOG2 = 5;
+		static constexpr u32 SIZE = 1 << SIZE_LOG2;
+		static constexpr u32 AREA = SIZE * SIZE;
+		static constexpr u32 VOLUME = SIZE * SIZE * SIZE;
+
+		explicit Chunk(BlockId fill = Block::Air);
+		~Chunk() = default;
+
+		Chunk(const Chunk&) = default;
+		Chunk& operator=(const Chunk&) = default;
+		Chunk(Chunk&&) = default;
+		Chunk& operator=(Chunk&&) = default;
+
+		// x varies fastest, then z, then y, so each horizontal layer is contiguous
+		static constexpr u32 index(const u32 x, const u32 y, const u32 z) {
+			return x | (z << SIZE_LOG2) | (y << (2 * SIZE_LOG2));
+		}
+
+		// No branches, a uniform chunk reads its one zero word with a zero mask
+		BlockId get(const u32 index) const {
+			const u32 bit = index * m_bits;
+			return m_palette[(m_data[bit >> 6] >> (bit & 63)) & m_mask];
+		}
+
+		BlockId get(const u32 x, const u32 y, const u32 z) const {
+			return get(index(x, y, z));
+		}
+
+		void set(u32 index, BlockId block);
+
+		void set(const u32 x, const u32 y, const u32 z, const BlockId block) {
+			set(index(x, y, z), block);
+		}
+
+		// Makes the whole chunk one block
+		void fill(BlockId block);
+		// Fills the box from `min` up to but not including `max`
+		void fill(glm::uvec3 min, glm::uvec3 max, BlockId block);
+
+		// Both take VOLUME blocks in index() order
+		void copy_from(std::span<const BlockId> blocks);
+		void copy_to(std::span<BlockId> blocks) const;
+
+		bool uniform() const {
+			return m_bits == 0;
+		}
+
+		u32 bits_per_block() const {
+			return m_bits;
+		}
+
+		// Distinct blocks in the chunk
+		u32 palette_size() const {
+			return m_live;
+		}
+
+		// Everything the chunk owns, including the object itself
+		usize memory_usage() const;
+
+	  private:
+		std::vector<BlockId> m_palette;
+		std::vector<u32> m_counts; // blocks using each entry, free entries are zero
+		std::vector<u64> m_data; // at least one word so get() never needs to check
+		u32 m_bits = 0;
+		u64 m_mask = 0;
+		u32 m_live = 1;
+
+		u32 raw(const u32 index) const {
+			const u32 bit = index * m_bits;
+			return static_cast<u32>((m_data[bit >> 6] >> (bit & 63)) & m_mask);
+		}
+
+		void write(const u32 index, const u32 entry) {
+			const u32 bit = index * m_bits;
+			u64& word = m_data[bit >> 6];
+			word = (word & ~(m_mask << (bit & 63))) | (static_cast<u64>(entry) << (bit & 63));
+		}
+
+		u32 entry_for(BlockId block);
+		void release(u32 entry, u32 count);
+		void repack(u32 bits, bool compact);
+	};
+} // namespace Vulxels::World
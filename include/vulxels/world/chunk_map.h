@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+
+#include <array>
+#include <bit>
+#include <glm/glm.hpp>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Vulxels::World {
+	// Chunks by chunk coordinate in a flat open-addressed table. Coordinates are
+	// packed into one 64-bit key, which is all a probe compares, and collisions
+	// are resolved by linear probing over an array of keys with the values in a
+	// parallel array so probing never touches them. Erasing shifts the rest of
+	// the run back rather than leaving tombstones. The last hit is remembered, as
+	// lookups tend to come in runs around the same chunk.
+	//
+	// Lookups update that cache, so even const ones mustn't race each other.
+	// Values only exist in occupied slots, an empty one doesn't construct a T.
+	template<typename T>
+	class ChunkMap {
+	  public:
+		// Bits per axis, coordinates wrap outside ±2^20 chunks
+		static constexpr u32 AXIS_BITS = 21;
+
+		// 3×3×3 around a chunk, the chunk itself in the middle
+		using Neighbourhood = std::array<T*, 27>;
+		using ConstNeighbourhood = std::array<const T*, 27>;
+
+		ChunkMap() {
+			rehash(MIN_CAPACITY);
+		}
+
+		// Packed x, then z, then y, matching the order of blocks in a chunk
+		static constexpr u64 key(const glm::ivec3 coord) {
+			return (static_cast<u64>(coord.x) & AXIS_MASK) | ((static_cast<u64>(coord.z) & AXIS_MASK) << AXIS_BITS)
+				| ((static_cast<u64>(coord.y) & AXIS_MASK) << (2 * AXIS_BITS));
+		}
+
+		static constexpr glm::ivec3 coord(const u64 key) {
+			// Shifted up to the sign bit and back down to sign extend each axis
+			const auto axis = [key](const u32 shift) {
+				return static_cast<i32>(static_cast<i64>(key << (64 - AXIS_BITS - shift)) >> (64 - AXIS_BITS));
+			};
+			return {axis(0), axis(2 * AXIS_BITS), axis(AXIS_BITS)};
+		}
+
+		// Index into a neighbourhood of the chunk at this offset, each in -1 to 1
+		static constexpr u32 neighbour_index(const i32 dx, const i32 dy, const i32 dz) {
+			return static_cast<u32>((dx + 1) + (dz + 1) * 3 + (dy + 1) * 9);
+		}
+
+		T* find(const glm::ivec3 coord) {
+			const u32 slot = find_slot(key(coord));
+			return slot == NONE ? nullptr : &*m_values[slot];
+		}
+
+		const T* find(const glm::ivec3 coord) const {
+			const u32 slot = find_slot(key(coord));
+			return slot == NONE ? nullptr : &*m_values[slot];
+		}
+
+		bool contains(const glm::ivec3 coord) const {
+			return find_slot(key(coord)) != NONE;
+		}
+
+		// Constructs the value only if the chunk isn't already there, returns it
+		// and whether it was inserted
+		template<typename... Args>
+		std::pair<T&, bool> try_emplace(const glm::ivec3 coord, Args&&... args) {
+			const u64 k = key(coord);
+			if (const u32 slot = find_slot(k); slot != NONE) {
+				return {*m_values[slot], false};
+			}
+			if ((m_size + 1) * MAX_LOAD_DEN > capacity() * MAX_LOAD_NUM) {
+				rehash(capacity() * 2);
+			}
+			u32 slot = home(k);
+			while (m_keys[slot] != EMPTY) {
+				slot = (slot + 1) & m_mask;
+			}
+			m_keys[slot] = k;
+			m_values[slot].emplace(std::forward<Args>(args)...);
+			m_size++;
+			m_last_key = k;
+			m_last_slot = slot;
+			return {*m_values[slot], true};
+		}
+
+		T& operator[](const glm::ivec3 coord) {
+			return try_emplace(coord).first;
+		}
+
+		bool erase(const glm::ivec3 coord) {
+			u32 slot = find_slot(key(coord));
+			if (slot == NONE) {
+				return false;
+			}
+			m_last_key = EMPTY;
+
+			// Pull later entries of the run back into the gap when their home slot
+			// doesn't lie cyclically between the gap and where they are now
+			for (u32 next = (slot + 1) & m_mask; m_keys[next] != EMPTY; next = (next + 1) & m_mask) {
+				const u32 h = home(m_keys[next]);
+				if (((next - h) & m_mask) >= ((next - slot) & m_mask)) {
+					m_keys[slot] = m_keys[next];
+					m_values[slot] = std::move(m_values[next]);
+					slot = next;
+				}
+			}
+			m_keys[slot] = EMPTY;
+			m_values[slot].reset();
+			m_size--;
+			return true;
+		}
+
+		// The chunk and its 26 neighbours, null where they aren't loaded
+		Neighbourhood neighbours(const glm::ivec3 coord) {
+			Neighbourhood result;
+			gather(coord, [&](const u32 index, const u32 slot) {
+				result[index] = slot == NONE ? nullptr : &*m_values[slot];
+			});
+			return result;
+		}
+
+		ConstNeighbourhood neighbours(const glm::ivec3 coord) const {
+			ConstNeighbourhood result;
+			gather(coord, [&](const u32 index, const u32 slot) {
+				result[index] = slot == NONE ? nullptr : &*m_values[slot];
+			});
+			return result;
+		}
+
+		// Calls func(coord, value) for every chunk, in no particular order
+		template<typename F>
+		void for_each(F&& func) {
+			for (u32 slot = 0; slot < capacity(); slot++) {
+				if (m_keys[slot] != EMPTY) {
+					func(coord(m_keys[slot]), *m_values[slot]);
+				}
+			}
+		}
+
+		template<typename F>
+		void for_each(F&& func) const {
+			for (u32 slot = 0; slot < capacity(); slot++) {
+				if (m_keys[slot] != EMPTY) {
+					func(coord(m_keys[slot]), *m_values[slot]);
+				}
+			}
+		}
+
+		// Makes room for `count` chunks without growing again
+		void reserve(const usize count) {
+			usize needed = MIN_CAPACITY;
+			while (count * MAX_LOAD_DEN > needed * MAX_LOAD_NUM) {
+				needed *= 2;
+			}
+			if (needed > capacity()) {
+				rehash(static_cast<u32>(needed));
+			}
+		}
+
+		void clear() {
+			m_size = 0;
+			rehash(MIN_CAPACITY);
+		}
+
+		usize size() const {
+			return m_size;
+		}
+
+		bool empty() const {
+			return m_size == 0;
+		}
+
+		u32 capacity() const {
+			return static_cast<u32>(m_keys.size());
+		}
+
+	  private:
+		static constexpr u64 AXIS_MASK = (u64(1) << AXIS_BITS) - 1;
+		static constexpr u64 EMPTY = ~u64(0); // the top bit is never set by key()
+		static constexpr u32 NONE = ~0u;
+		static constexpr u32 MIN_CAPACITY = 16;
+		static constexpr u32 MAX_LOAD_NUM = 3; // grows past three quarters full
+		static constexpr u32 MAX_LOAD_DEN = 4;
+
+		std::vector<u64> m_keys;
+		std::vector<std::optional<T>> m_values;
+		usize m_size = 0;
+		u32 m_mask = 0;
+		u32 m_shift = 0;
+		mutable u64 m_last_key = EMPTY;
+		mutable u32 m_last_slot = 0;
+
+		// Neighbouring chunks have keys a few bits apart, so the key is mixed
+		// before taking the top bits of a Fibonacci hash
+		u32 home(u64 k) const {
+			k ^= k >> 29;
+			return static_cast<u32>((k * 0x9e3779b97f4a7c15) >> m_shift);
+		}
+
+		u32 find_slot(const u64 k) const {
+			if (k == m_last_key) {
+				return m_last_slot;
+			}
+			const u32 slot = probe(k);
+			if (slot != NONE) {
+				m_last_key = k;
+				m_last_slot = slot;
+			}
+			return slot;
+		}
+
+		template<typename F>
+		void gather(const glm::ivec3 coord, F&& found) const {
+			// Only the centre goes through the cache, the rest would just evict it
+			found(neighbour_index(0, 0, 0), find_slot(key(coord)));
+			for (i32 dy = -1; dy <= 1; dy++) {
+				for (i32 dz = -1; dz <= 1; dz++) {
+					for (i32 dx = -1; dx <= 1; dx++) {
+						if (dx == 0 && dy == 0 && dz == 0) {
+							continue;
+						}
+						found(neighbour_index(dx, dy, dz), probe(key(coord + glm::ivec3(dx, dy, dz))));
+					}
+				}
+			}
+		}
+
+		// Walks the run from the key's home slot, skipping the cache
+		u32 probe(const u64 k) const {
+			for (u32 slot = home(k);; slot = (slot + 1) & m_mask) {
+				if (m_keys[slot] == k) {
+					return slot;
+				}
+				if (m_keys[slot] == EMPTY) {
+					return NONE;
+				}
+			}
+		}
+
+		void rehash(const u32 capacity) {
+			auto keys = std::move(m_keys);
+			auto values = std::move(m_values);
+			m_keys.assign(capacity, EMPTY);
+			m_values = std::vector<std::optional<T>>(capacity);
+			m_mask = capacity - 1;
+			m_shift = 64 - static_cast<u32>(std::countr_zero(capacity));
+			m_last_key = EMPTY;
+
+			for (usize i = 0; i < keys.size(); i++) {
+				if (keys[i] == EMPTY) {
+					continue;
+				}
+				u32 slot = home(keys[i]);
+				while (m_keys[slot] != EMPTY) {
+					slot = (slot + 1) & m_mask;
+				}
+				m_keys[slot] = keys[i];
+				m_values[slot] = std::move(values[i]);
+			}
+		}
+	};
+} // namespace Vulxels::World
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+#include <vulxels/world/chunk.h>
+
+#include <array>
+#include <vector>
+
+namespace Vulxels::World {
+	enum class Face : u8 {
+		PosX,
+		NegX,
+		PosY,
+		NegY,
+		PosZ,
+		NegZ,
+	};
+
+	// A whole quad in two words, read by voxel.vert from a storage buffer with
+	// its corners expanded from gl_VertexIndex, so no vertices are stored.
+	//
+	//   position: x, y, z of the first corner (6 bits each), width - 1 and
+	//             height - 1 across the face (5 bits each), face (3 bits)
+	//   material: block (16 bits), ambient occlusion of each corner (2 bits each)
+	//
+	// Texture coordinates run from 0 to the width and height across the quad.
+	struct ChunkQuad {
+		u32 position;
+		u32 material;
+
+		static constexpr ChunkQuad pack(
+			const glm::uvec3 corner,
+			const u32 width,
+			const u32 height,
+			const Face face,
+			const BlockId block,
+			const u8 ao
+		) {
+			return {
+				corner.x | (corner.y << 6) | (corner.z << 12) | ((width - 1) << 18) | ((height - 1) << 23)
+					| (static_cast<u32>(face) << 28),
+				static_cast<u32>(block) | (static_cast<u32>(ao) << 16)
+			};
+		}
+
+		glm::uvec3 corner() const {
+			return {position & 63, (position >> 6) & 63, (position >> 12) & 63};
+		}
+
+		u32 width() const {
+			return ((position >> 18) & 31) + 1;
+		}
+
+		u32 height() const {
+			return ((position >> 23) & 31) + 1;
+		}
+
+		Face face() const {
+			return static_cast<Face>((position >> 28) & 7);
+		}
+
+		BlockId block() const {
+			return static_cast<BlockId>(material & 0xffff);
+		}
+
+		// 0 is fully occluded and 3 is open, corners in the order voxel.vert walks them
+		u32 ao(const u32 corner) const {
+			return (material >> (16 + corner * 2)) & 3;
+		}
+	};
+
+	// Builds a chunk's visible faces, merged into as few quads as possible.
+	//
+	// Occupancy is kept as one bit per block in columns along each axis, with a
+	// bit either side from the neighbouring chunks. Faces are culled a column at
+	// a time with a shift and an AND, transposed into planes of rows, and grown
+	// into quads a run of bits at a time with bit scans. Only faces of the same
+	// block and ambient occlusion are merged. The scratch space is kept between
+	// calls and is large, so keep one mesher per thread rather than one per call
+	// or on the stack.
+	class Mesher {
+	  public:
+		// In ChunkMap::neighbours() order, the middle is ignored and missing
+		// chunks are treated as air
+		using Neighbours = std::array<const Chunk*, 27>;
+
+		// Every other block solid, each with all six faces showing
+		static constexpr u32 MAX_QUADS = Chunk::VOLUME * 3;
+
+		void mesh(const Chunk& chunk, const Neighbours& neighbours, std::vector<ChunkQuad>& quads);
+
+		// Two triangles per quad, each quad's corners counted from 4 × its index
+		static std::vector<u32> quad_indices(u32 quads);
+
+	  private:
+		static constexpr u32 SIZE = Chunk::SIZE;
+		static constexpr u32 PADDED = SIZE + 2;
+
+		// One block's faces in a layer with the same occlusion, bit v of row u
+		struct Plane {
+			BlockId block;
+			u8 ao;
+			std::array<u32, SIZE> rows;
+		};
+
+		std::array<BlockId, Chunk::VOLUME> m_blocks;
+		std::array<u64, PADDED * PADDED> m_padded; // [y + 1][z + 1], bit x + 1, for occlusion
+		std::array<std::array<u64, SIZE * SIZE>, 3> m_columns; // per axis, bits 1 to 32 are this chunk
+		std::array<std::array<u32, SIZE>, SIZE> m_layers; // one direction's faces, rows of each layer
+		std::vector<Plane> m_planes;
+
+		void build_columns(const Neighbours& neighbours);
+		void mesh_face(Face face, std::vector<ChunkQuad>& quads);
+		u8 occlusion(Face face, glm::uvec3 block) const;
+		void merge(Face face, u32 layer, Plane& plane, std::vector<ChunkQuad>& quads) const;
+
+		// Any block of the chunk or the layer around it, from -1 to 32
+		bool solid(const i32 x, const i32 y, const i32 z) const {
+			return (m_padded[(y + 1) * PADDED + (z + 1)] >> (x + 1)) & 1;
+		}
+	};
+} // namespace Vulxels::World
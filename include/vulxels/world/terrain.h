@@ -0,0 +1,36 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <vulxels/types.h>
+#include <vulxels/world/chunk.h>
+
+#include <glm/glm.hpp>
+
+namespace Vulxels::World {
+	// Rolling hills with sand around the sea, snow on the peaks and caves under
+	// the surface. Noise is hashed from the coordinates rather than looked up,
+	// so any chunk can be generated on its own, in any order, on any thread.
+	class TerrainGenerator {
+	  public:
+		static constexpr i32 SEA_LEVEL = 0;
+
+		explicit TerrainGenerator(u64 seed);
+
+		void generate(glm::ivec3 chunk_coord, Chunk& chunk) const;
+
+		// Surface height in blocks
+		i32 height(i32 x, i32 z) const;
+
+	  private:
+		u64 m_seed;
+
+		f32 noise(i32 x, i32 z, f32 frequency) const;
+		f32 noise(i32 x, i32 y, i32 z, f32 frequency) const;
+		f32 lattice(i64 x, i64 y, i64 z) const;
+	};
+} // namespace Vulxels::World
@@ -0,0 +1,19 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#version 450
+
+layout(location = 0) in vec3 inColor;
+layout(location = 1) in vec2 inUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	// UVs count blocks across the quad, so darken the edge of each one
+	vec2 edge = min(fract(inUV), 1.0 - fract(inUV));
+	float outline = smoothstep(0.0, 0.04, min(edge.x, edge.y));
+	outColor = vec4(inColor * mix(0.85, 1.0, outline), 1.0);
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Shared by voxel.vert and voxel_fallback.vert, which differ only in where
+// each chunk's quads are bound
+
+layout(push_constant) uniform PushConstants {
+	mat4 viewProj;
+	ivec4 origin; // The chunk's first block in the world, w indexes its quads when bindless
+} pc;
+
+layout(location = 0) out vec3 outColor;
+layout(location = 1) out vec2 outUV;
+
+// Indexed by World::BlockId
+const vec3 COLORS[7] = vec3[](
+	vec3(1.0, 0.0, 1.0), // Air, never meshed
+	vec3(0.50, 0.50, 0.52), // Stone
+	vec3(0.45, 0.32, 0.20), // Dirt
+	vec3(0.32, 0.58, 0.24), // Grass
+	vec3(0.86, 0.80, 0.56), // Sand
+	vec3(0.94, 0.96, 0.98), // Snow
+	vec3(0.20, 0.40, 0.75) // Water
+);
+
+// +x, -x, +y, -y, +z, -z
+const float SHADE[6] = float[](0.8, 0.8, 1.0, 0.5, 0.65, 0.65);
+
+// The u and v axes across the faces of each axis, as in the mesher
+const ivec2 TANGENTS[3] = ivec2[](ivec2(1, 2), ivec2(2, 0), ivec2(1, 0));
+
+const float AO_CURVE[4] = float[](0.35, 0.6, 0.8, 1.0);
+
+// Emits the corner of `quad` that gl_VertexIndex picks
+void emit_vertex(uvec2 quad) {
+	uint face = (quad.x >> 28) & 7u;
+	uint axis = face / 2u;
+	uint width = ((quad.x >> 18) & 31u) + 1u;
+	uint height = ((quad.x >> 23) & 31u) + 1u;
+
+	// Corners go counter-clockwise seen from outside, which walks the tangents
+	// backwards for the faces where u × v points into the block
+	uint vertex = uint(gl_VertexIndex) & 3u;
+	bool forward = face == 0u || face == 2u || face == 5u;
+	uint corner = forward ? vertex : (4u - vertex) & 3u;
+	uvec2 uv = uvec2(corner == 1u || corner == 2u, corner >= 2u);
+
+	ivec3 position = ivec3(quad.x & 63u, (quad.x >> 6) & 63u, (quad.x >> 12) & 63u);
+	position[TANGENTS[axis].x] += int(uv.x * width);
+	position[TANGENTS[axis].y] += int(uv.y * height);
+	gl_Position = pc.viewProj * vec4(vec3(pc.origin.xyz + position), 1.0);
+
+	uint block = quad.y & 0xffffu;
+	uint ao = (quad.y >> (16u + corner * 2u)) & 3u;
+	outColor = COLORS[min(block, 6u)] * SHADE[face] * AO_CURVE[ao];
+	outUV = vec2(uv * uvec2(width, height));
+}
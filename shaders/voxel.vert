@@ -0,0 +1,21 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_GOOGLE_include_directive : require
+
+// World::ChunkQuad, one per four vertices, corners come from gl_VertexIndex.
+// Every chunk's quads are in the bindless table's buffers, pc.origin.w picks one.
+layout(set = 0, binding = 1) readonly buffer Quads {
+	uvec2 quads[];
+} chunks[];
+
+#include "voxel.glsl"
+
+void main() {
+	emit_vertex(chunks[pc.origin.w].quads[gl_VertexIndex >> 2]);
+}
@@ -0,0 +1,20 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// World::ChunkQuad, one per four vertices, corners come from gl_VertexIndex.
+// Without descriptor indexing each chunk's quads get a set of their own.
+layout(set = 0, binding = 0) readonly buffer Quads {
+	uvec2 quads[];
+};
+
+#include "voxel.glsl"
+
+void main() {
+	emit_vertex(quads[gl_VertexIndex >> 2]);
+}
@@ -8,36 +8,52 @@
 #include <backends/imgui_impl_vulkan.h>
 #include <imgui.h>
 #include <vulxels/app.h>
-#include <vulxels/gfx/buffer.h>
+#include <vulxels/gfx/chunk_renderer.h>
 #include <vulxels/gfx/descriptors.h>
+#include <vulxels/gfx/render_graph.h>
 #include <vulxels/log.h>
 #include <vulxels/types.h>
 #include <vulxels/version.h>
+#include <vulxels/world/chunk_map.h>
+#include <vulxels/world/mesher.h>
+#include <vulxels/world/terrain.h>
 
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
 #include <cstdio>
+#include <exception>
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <utility>
 #include <vector>
 
 using namespace Vulxels;
 
-struct Vertex {
-	glm::vec2 pos;
-	glm::vec3 color;
-};
+static constexpr vk::Format DEPTH_FORMAT = vk::Format::eD32Sfloat;
+
+// 12×6×12 chunks of terrain around the origin
+static constexpr glm::ivec3 WORLD_MIN {-6, -3, -6};
+static constexpr glm::ivec3 WORLD_MAX {6, 3, 6};
+static constexpr u64 WORLD_SEED = 1;
 
-static std::shared_ptr<vk::raii::RenderPass> s_render_pass;
-static std::shared_ptr<GFX::Pipeline> s_pipeline;
-static std::shared_ptr<GFX::Buffer> s_vertex_buffer;
-static std::shared_ptr<GFX::Buffer> s_index_buffer;
+static std::unique_ptr<GFX::RenderGraph> s_graph;
+static vk::Format s_color_format; // ImGui keeps a pointer to it for dynamic rendering
+static std::unique_ptr<GFX::ChunkRenderer> s_chunk_renderer;
 static std::shared_ptr<GFX::DescriptorPool> s_imgui_pool;
 
-static std::vector<Vertex> s_vertices = {
-	{{-1.0f, -1.0f}, {1.0f, 0.0f, 0.0f}},
-	{{-1.0f, 1.0f}, {0.0f, 1.0f, 0.0f}},
-	{{1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}},
-	{{1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}
+// Generated and meshed in the background, then uploaded from the main thread
+// once every chunk is done
+struct WorldLoad {
+	World::TerrainGenerator generator {WORLD_SEED};
+	World::ChunkMap<World::Chunk> chunks;
+	std::vector<glm::ivec3> coords;
+	std::vector<std::vector<World::ChunkQuad>> meshes;
+	JobSystem::Counter generated;
+	JobSystem::Counter meshed;
 };
-static std::vector<u32> s_indices = {0, 1, 2, 2, 3, 0};
+static std::unique_ptr<WorldLoad> s_world;
 
 static void imgui_vulkan_err(const VkResult err) {
 	if (err == 0)
@@ -48,64 +64,67 @@ static void imgui_vulkan_err(const VkResult err) {
 	}
 }
 
-App::App() {
-	auto vert = m_renderer.create_shader("simple.vert.spv");
-	auto frag = m_renderer.create_shader("simple.frag.spv");
-
-	s_render_pass = std::make_shared<vk::raii::RenderPass>(
-		m_renderer.device().device(),
-		vk::RenderPassCreateInfo()
-			.setAttachments(
-				{vk::AttachmentDescription()
-					 .setFormat(m_renderer.swapchain().format().format)
-					 .setSamples(vk::SampleCountFlagBits::e1)
-					 .setLoadOp(vk::AttachmentLoadOp::eClear)
-					 .setStoreOp(vk::AttachmentStoreOp::eStore)
-					 .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
-					 .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-					 .setInitialLayout(vk::ImageLayout::eUndefined)
-					 .setFinalLayout(vk::ImageLayout::ePresentSrcKHR)}
-			)
-			.setSubpasses(
-				{vk::SubpassDescription()
-					 .setPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
-					 .setColorAttachments({vk::AttachmentReference().setAttachment(0).setLayout(
-						 vk::ImageLayout::eColorAttachmentOptimal
-					 )})}
-			)
-			.setDependencies(
-				{vk::SubpassDependency()
-					 .setSrcSubpass(VK_SUBPASS_EXTERNAL)
-					 .setDstSubpass(0)
-					 .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-					 .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
-					 .setSrcAccessMask(vk::AccessFlagBits::eNoneKHR)
-					 .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
-					 .setDependencyFlags(vk::DependencyFlagBits::eByRegion)}
-			)
-	);
+static void load_world(JobSystem& jobs) {
+	VX_ZONE("load_world");
+	s_world = std::make_unique<WorldLoad>();
+	auto& world = *s_world;
 
-	m_renderer.swapchain().set_render_pass(s_render_pass);
-
-	s_pipeline = std::make_shared<GFX::Pipeline>(
-		m_renderer.device(),
-		m_renderer.create_pipeline()
-			.use_default()
-			.add_shader_stage(vert.module(), vk::ShaderStageFlagBits::eVertex)
-			.add_shader_stage(frag.module(), vk::ShaderStageFlagBits::eFragment)
-			.add_vertex_binding_description(0, sizeof(Vertex), vk::VertexInputRate::eVertex)
-			.add_vertex_attribute_description(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, pos))
-			.add_vertex_attribute_description(0, 1, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color))
-			.set_render_pass(s_render_pass)
-	);
+	// Every chunk is in the map before any job starts, so it never rehashes
+	// under them, and jobs get pointers rather than sharing the map's lookups
+	for (i32 y = WORLD_MIN.y; y < WORLD_MAX.y; y++) {
+		for (i32 z = WORLD_MIN.z; z < WORLD_MAX.z; z++) {
+			for (i32 x = WORLD_MIN.x; x < WORLD_MAX.x; x++) {
+				world.coords.emplace_back(x, y, z);
+				world.chunks.try_emplace({x, y, z});
+			}
+		}
+	}
+	world.meshes.resize(world.coords.size());
+
+	for (const auto coord : world.coords) {
+		auto* chunk = world.chunks.find(coord);
+		jobs.run(
+			[&world, chunk, coord] { world.generator.generate(coord, *chunk); },
+			JobSystem::Priority::Low,
+			&world.generated
+		);
+	}
+
+	// Meshing reads the neighbours too, so none of it starts until they're all generated
+	const auto& chunks = std::as_const(world.chunks);
+	for (usize i = 0; i < world.coords.size(); i++) {
+		jobs.run(
+			[&world, i, chunk = chunks.find(world.coords[i]), neighbours = chunks.neighbours(world.coords[i])] {
+				thread_local auto mesher = std::make_unique<World::Mesher>();
+				mesher->mesh(*chunk, neighbours, world.meshes[i]);
+			},
+			JobSystem::Priority::Low,
+			&world.meshed,
+			&world.generated
+		);
+	}
+}
 
-	s_vertex_buffer = std::make_shared<
-		GFX::Buffer>(m_renderer.device(), sizeof(Vertex) * s_vertices.size(), vk::BufferUsageFlagBits::eVertexBuffer);
-	s_index_buffer = std::make_shared<
-		GFX::Buffer>(m_renderer.device(), sizeof(u32) * s_indices.size(), vk::BufferUsageFlagBits::eIndexBuffer);
+static void poll_world(JobSystem& jobs) {
+	if (!s_world || !s_world->meshed.done()) {
+		return;
+	}
+	VX_ZONE("poll_world");
+	auto& world = *s_world;
+	jobs.wait(world.generated);
+	jobs.wait(world.meshed);
+	for (usize i = 0; i < world.coords.size(); i++) {
+		s_chunk_renderer->upload(world.coords[i], world.meshes[i]);
+	}
+	s_world.reset();
+}
 
-	s_vertex_buffer->write(s_vertices);
-	s_index_buffer->write(s_indices);
+App::App(const GFX::RendererConfig& config) : m_renderer(m_window, config) {
+	s_graph = std::make_unique<GFX::RenderGraph>(m_renderer);
+	const auto color_format = m_renderer.swapchain().format().format;
+
+	s_chunk_renderer = std::make_unique<GFX::ChunkRenderer>(m_renderer, *s_graph, color_format, DEPTH_FORMAT);
+	load_world(m_renderer.jobs());
 
 	s_imgui_pool = std::make_shared<GFX::DescriptorPool>(m_renderer.device());
 	s_imgui_pool->set_max_sets(1000);
@@ -139,23 +158,195 @@ App::App() {
 	init_info.DescriptorPool = *s_imgui_pool->pool();
 	init_info.Subpass = 0;
 	init_info.MinImageCount = 2;
-	init_info.ImageCount = m_renderer.swapchain().image_count();
+	// ImGui cycles its buffers per frame, so it needs one for every frame in flight
+	init_info.ImageCount = std::max(m_renderer.swapchain().image_count(), GFX::Renderer::MAX_FRAMES_IN_FLIGHT);
 	init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
-	init_info.RenderPass = **s_render_pass;
+	if (s_graph->dynamic_rendering()) {
+		s_color_format = color_format;
+		init_info.UseDynamicRendering = true;
+		init_info.PipelineRenderingCreateInfo =
+			vk::PipelineRenderingCreateInfoKHR().setColorAttachmentFormats(s_color_format);
+	} else {
+		init_info.RenderPass = **s_graph->compatible_render_pass({color_format});
+	}
 	init_info.CheckVkResultFn = imgui_vulkan_err;
 	ImGui_ImplVulkan_Init(&init_info);
 }
 
-static void draw_gui() {
+static void draw_gpu_timings(GFX::Renderer& renderer) {
+	auto& profiler = renderer.profiler();
+	if (!profiler.supported()) {
+		return;
+	}
+
+	ImGui::Separator();
+	const auto& history = profiler.history();
+	if (!history.empty()) {
+		const std::vector<f32> values(history.begin(), history.end());
+		const auto overlay = fmt::format("GPU {:.3f} ms", values.back());
+		ImGui::PlotLines(
+			"##gpu",
+			values.data(),
+			static_cast<int>(values.size()),
+			0,
+			overlay.c_str(),
+			0.0f,
+			FLT_MAX,
+			{0, 60}
+		);
+	}
+	for (const auto& timing : profiler.timings()) {
+		ImGui::Indent(static_cast<f32>(timing.depth) * 8.0f + 1.0f);
+		ImGui::Text("%s: %.3f ms", timing.name.c_str(), timing.ms);
+		ImGui::Unindent(static_cast<f32>(timing.depth) * 8.0f + 1.0f);
+	}
+	if (ImGui::Button("Export GPU timings")) {
+		try {
+			profiler.export_csv("gpu_timings.csv");
+		} catch (const std::exception& e) {
+			VX_ERROR("Failed to export GPU timings: {}", e.what());
+		}
+	}
+}
+
+static void draw_job_stats(JobSystem& jobs) {
+	const auto stats = jobs.stats();
+	ImGui::Separator();
+	ImGui::Text("Workers: %zu", stats.size());
+	for (const auto& worker : stats) {
+		const auto overlay = fmt::format(
+			"{:.0f}%, {} jobs, {} stolen",
+			worker.utilisation * 100.0f,
+			worker.jobs,
+			worker.stolen
+		);
+		ImGui::ProgressBar(worker.utilisation, {-FLT_MIN, 0.0f}, overlay.c_str());
+	}
+}
+
+static void draw_renderer_settings(GFX::Renderer& renderer) {
+	static constexpr std::array present_modes = {
+		vk::PresentModeKHR::eImmediate,
+		vk::PresentModeKHR::eMailbox,
+		vk::PresentModeKHR::eFifo,
+		vk::PresentModeKHR::eFifoRelaxed
+	};
+	static constexpr std::array present_mode_names = {"Immediate", "Mailbox", "FIFO", "FIFO relaxed"};
+
+	// Measured for the swapchain and frame count actually in use, which can lag
+	// the settings below by a frame
+	ImGui::Separator();
+	ImGui::Text(
+		"%s, %u images, %u frames in flight",
+		vk::to_string(renderer.swapchain().present_mode()).c_str(),
+		renderer.swapchain().image_count(),
+		renderer.config().frames_in_flight
+	);
+	ImGui::Text(
+		"Latency: %.2f ms input to %s",
+		renderer.latency(),
+		renderer.latency_to_present() ? "present" : "GPU completion"
+	);
+
+	auto config = renderer.config();
+	bool changed = false;
+
+	int frames = static_cast<int>(config.frames_in_flight);
+	if (ImGui::SliderInt("Frames in flight", &frames, 1, GFX::Renderer::MAX_FRAMES_IN_FLIGHT)) {
+		config.frames_in_flight = static_cast<u32>(frames);
+		changed = true;
+	}
+
+	int mode = static_cast<int>(std::ranges::find(present_modes, config.present_mode) - present_modes.begin());
+	if (ImGui::Combo("Present mode", &mode, present_mode_names.data(), static_cast<int>(present_mode_names.size()))) {
+		config.present_mode = present_modes[mode];
+		changed = true;
+	}
+
+	int images = static_cast<int>(config.image_count);
+	if (ImGui::SliderInt("Swapchain images", &images, 0, 8, images == 0 ? "Auto" : "%d")) {
+		config.image_count = static_cast<u32>(images);
+		changed = true;
+	}
+
+	const char* limit_format = config.frame_limit == 0.0f ? "Off" : "%.0f FPS";
+	changed |= ImGui::SliderFloat("Frame limit", &config.frame_limit, 0.0f, 480.0f, limit_format);
+
+	if (changed) {
+		renderer.set_config(config);
+	}
+}
+
+static void draw_gui(GFX::Renderer& renderer) {
 	const ImGuiIO& io = ImGui::GetIO();
 	if (ImGui::Begin("Statistics")) {
 		ImGui::Text("Vulxels %d.%d.%d", VX_VERSION_MAJOR, VX_VERSION_MINOR, VX_VERSION_PATCH);
 		ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+
+		const auto mem = renderer.device().allocator().statistics();
+		ImGui::Separator();
+		ImGui::Text("GPU memory: %.2f / %.2f MiB", mem.bytes_used / 1048576.0, mem.bytes_reserved / 1048576.0);
+		ImGui::Text("Blocks: %u, allocations: %u", mem.block_count, mem.allocation_count);
+		ImGui::Text("Free ranges: %u (%.1f%% fragmented)", mem.free_range_count, mem.fragmentation() * 100.0f);
+
+		const auto& pipelines = renderer.pipelines();
+		ImGui::Separator();
+		ImGui::Text(
+			"Pipelines: %zu (%llu hits, %llu misses, %u compiling)",
+			pipelines.size(),
+			static_cast<unsigned long long>(pipelines.hits()),
+			static_cast<unsigned long long>(pipelines.misses()),
+			pipelines.pending()
+		);
+
+		const auto& graph = s_graph->stats();
+		ImGui::Separator();
+		ImGui::Text("Render passes: %u (%u culled)", graph.passes, graph.culled);
+		ImGui::Text(
+			"Transient images: %u in %u allocations, %.2f / %.2f MiB",
+			graph.transient_images,
+			graph.allocations,
+			graph.memory / 1048576.0,
+			graph.unaliased_memory / 1048576.0
+		);
+
+		const auto& chunks = s_chunk_renderer->stats();
+		ImGui::Separator();
+		if (s_world) {
+			ImGui::Text(
+				"Loading: %u to generate, %u to mesh",
+				s_world->generated.pending(),
+				s_world->meshed.pending()
+			);
+		}
+		ImGui::Text(
+			"Chunks: %u, quads: %llu, %.2f MiB",
+			chunks.chunks,
+			static_cast<unsigned long long>(chunks.quads),
+			chunks.memory / 1048576.0
+		);
+
+		draw_job_stats(renderer.jobs());
+		draw_gpu_timings(renderer);
+		draw_renderer_settings(renderer);
 	}
 	ImGui::End();
 }
 
+// Circles the middle of the world, looking down at it
+static glm::mat4 camera(const f32 aspect) {
+	const f32 t = static_cast<f32>(SDL_GetTicks()) / 1000.0f * 0.05f;
+	const f32 radius = static_cast<f32>(WORLD_MAX.x * World::Chunk::SIZE) * 1.2f;
+	const glm::vec3 eye(std::cos(t) * radius, 96.0f, std::sin(t) * radius);
+	auto projection = glm::perspective(glm::radians(70.0f), aspect, 0.1f, 1000.0f);
+	projection[1][1] *= -1.0f;
+	return projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
 static void draw(GFX::Renderer& renderer) {
+	VX_ZONE("draw");
+	poll_world(renderer.jobs());
+
 	const auto cmd = renderer.begin_frame();
 	if (!cmd) {
 		return;
@@ -165,42 +356,48 @@ static void draw(GFX::Renderer& renderer) {
 	ImGui_ImplSDL3_NewFrame();
 	ImGui::NewFrame();
 
-	draw_gui();
+	draw_gui(renderer);
 
-	cmd->beginRenderPass(
-		vk::RenderPassBeginInfo()
-			.setRenderPass(*s_render_pass)
-			.setFramebuffer(renderer.swapchain().framebuffer())
-			.setRenderArea({{0, 0}, renderer.swapchain().extent()})
-			.setClearValues({vk::ClearValue().setColor({0.0f, 0.0f, 0.0f, 1.0f})}),
-		vk::SubpassContents::eInline
-	);
+	ImGui::Render();
 
-	cmd->setViewport(
-		0,
-		{vk::Viewport()
-			 .setX(0.0f)
-			 .setY(0.0f)
-			 .setWidth(static_cast<f32>(renderer.swapchain().extent().width))
-			 .setHeight(static_cast<f32>(renderer.swapchain().extent().height))
-			 .setMinDepth(0.0f)
-			 .setMaxDepth(1.0f)}
-	);
-	cmd->setScissor(0, {vk::Rect2D().setOffset({0, 0}).setExtent(renderer.swapchain().extent())});
+	auto& graph = *s_graph;
+	graph.reset();
+	const auto backbuffer = graph.import_backbuffer();
+	const auto depth = graph.create_image("Depth", {DEPTH_FORMAT});
 
-	cmd->bindVertexBuffers(0, {s_vertex_buffer->buffer()}, {0});
-	cmd->bindIndexBuffer(s_index_buffer->buffer(), 0, vk::IndexType::eUint32);
-	cmd->bindPipeline(vk::PipelineBindPoint::eGraphics, s_pipeline->pipeline());
-	cmd->drawIndexed(s_indices.size(), 1, 0, 0, 0);
+	// The chunks are recorded into secondary buffers in batches across the workers
+	const auto view_proj = camera(renderer.swapchain().aspect());
+	graph
+		.add_pass(
+			"Scene",
+			[view_proj](const GFX::RenderGraph::PassContext& context) {
+				s_chunk_renderer->draw(context, view_proj);
+			}
+		)
+		.write_color(backbuffer, vk::ClearColorValue(0.5f, 0.7f, 0.9f, 1.0f))
+		.write_depth(depth, 1.0f)
+		.use_secondary_buffers();
 
-	ImGui::Render();
-	ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), **cmd);
+	graph
+		.add_pass(
+			"ImGui",
+			[](const GFX::RenderGraph::PassContext& context) {
+				ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), *context.cmd);
+			}
+		)
+		.write_color(backbuffer);
 
-	cmd->endRenderPass();
+	graph.execute(*cmd);
 	renderer.end_frame(cmd);
 }
 
 App::~App() {
+	// Jobs still loading the world reference it
+	if (s_world) {
+		m_renderer.jobs().wait(s_world->generated);
+		m_renderer.jobs().wait(s_world->meshed);
+		s_world.reset();
+	}
 	m_renderer.device().wait_idle();
 
 	ImGui_ImplVulkan_Shutdown();
@@ -208,16 +405,15 @@ App::~App() {
 	ImGui::DestroyContext();
 
 	s_imgui_pool.reset();
-	s_index_buffer.reset();
-	s_vertex_buffer.reset();
-	s_pipeline.reset();
-	s_render_pass.reset();
+	s_chunk_renderer.reset();
+	s_graph.reset();
 }
 
 void App::run() {
 	SDL_Event event;
 
 	while (m_running) {
+		VX_ZONE("Frame");
 		while (SDL_PollEvent(&event) != 0) {
 			ImGui_ImplSDL3_ProcessEvent(&event);
 			m_renderer.handle_events(event);
@@ -227,8 +423,17 @@ void App::run() {
 			if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_ESCAPE) {
 				m_running = false;
 			}
+#ifdef VX_PROFILE
+			if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F2) {
+				Profiler::capture();
+			}
+#endif
 		}
+		m_renderer.mark_input();
 
 		draw(m_renderer);
+#ifdef VX_PROFILE
+		Profiler::frame();
+#endif
 	}
 }
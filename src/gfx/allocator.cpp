@@ -0,0 +1,254 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/allocator.h>
+#include <vulxels/gfx/device.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace Vulxels::GFX;
+
+static constexpr vk::DeviceSize align_up(const vk::DeviceSize value, const vk::DeviceSize alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+Allocation::~Allocation() {
+	release();
+}
+
+Allocation::Allocation(Allocation&& other) noexcept {
+	*this = std::move(other);
+}
+
+Allocation& Allocation::operator=(Allocation&& other) noexcept {
+	if (this != &other) {
+		release();
+		m_allocator = std::exchange(other.m_allocator, nullptr);
+		m_block = std::exchange(other.m_block, nullptr);
+		m_memory = std::exchange(other.m_memory, nullptr);
+		m_offset = std::exchange(other.m_offset, 0);
+		m_size = std::exchange(other.m_size, 0);
+		m_memory_type = std::exchange(other.m_memory_type, 0);
+		m_mapped = std::exchange(other.m_mapped, nullptr);
+	}
+	return *this;
+}
+
+void Allocation::release() {
+	if (m_allocator) {
+		m_allocator->free(*this);
+		m_allocator = nullptr;
+		m_block = nullptr;
+		m_mapped = nullptr;
+	}
+}
+
+void Allocator::Block::insert_free(const vk::DeviceSize offset, const vk::DeviceSize size) {
+	free_by_offset.emplace(offset, size);
+	free_by_size.emplace(size, offset);
+}
+
+void Allocator::Block::erase_free(const std::map<vk::DeviceSize, vk::DeviceSize>::iterator it) {
+	auto [first, last] = free_by_size.equal_range(it->second);
+	for (; first != last; ++first) {
+		if (first->second == it->first) {
+			free_by_size.erase(first);
+			break;
+		}
+	}
+	free_by_offset.erase(it);
+}
+
+Allocator::Allocator(Device& device, const vk::DeviceSize block_size) : m_device(device), m_block_size(block_size) {
+	m_memory_properties = m_device.physical_device().getMemoryProperties();
+	const auto limits = m_device.physical_device().getProperties().limits;
+	m_granularity = limits.bufferImageGranularity;
+	m_atom_size = limits.nonCoherentAtomSize;
+	m_blocks.resize(m_memory_properties.memoryTypeCount);
+}
+
+Allocation Allocator::allocate(
+	const vk::MemoryRequirements& requirements,
+	const vk::MemoryPropertyFlags properties,
+	const bool linear
+) {
+	const u32 memory_type = find_memory_type(requirements.memoryTypeBits, properties);
+	const auto type_flags = m_memory_properties.memoryTypes[memory_type].propertyFlags;
+
+	vk::DeviceSize alignment = requirements.alignment;
+	vk::DeviceSize size = requirements.size;
+	if (!linear) {
+		// Keep optimal-tiling resources on their own granularity pages
+		alignment = std::max(alignment, m_granularity);
+		size = align_up(size, m_granularity);
+	}
+	if ((type_flags & vk::MemoryPropertyFlagBits::eHostVisible)
+		&& !(type_flags & vk::MemoryPropertyFlagBits::eHostCoherent)) {
+		// Flushes and invalidates must cover whole atoms
+		alignment = std::max(alignment, m_atom_size);
+		size = align_up(size, m_atom_size);
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	Block* block = nullptr;
+	vk::DeviceSize offset = 0;
+
+	if (size <= m_block_size / 2) {
+		for (const auto& candidate : m_blocks[memory_type]) {
+			if (candidate->size == m_block_size && allocate_from(*candidate, size, alignment, offset)) {
+				block = candidate.get();
+				break;
+			}
+		}
+	}
+
+	if (!block) {
+		block = &create_block(memory_type, size > m_block_size / 2 ? size : m_block_size);
+		if (!allocate_from(*block, size, alignment, offset)) {
+			throw std::runtime_error("Failed to sub-allocate device memory");
+		}
+	}
+
+	block->used += size;
+	block->allocation_count++;
+
+	Allocation allocation;
+	allocation.m_allocator = this;
+	allocation.m_block = block;
+	allocation.m_memory = *block->memory;
+	allocation.m_offset = offset;
+	allocation.m_size = size;
+	allocation.m_memory_type = memory_type;
+	allocation.m_mapped = block->mapped ? static_cast<u8*>(block->mapped) + offset : nullptr;
+	return allocation;
+}
+
+void Allocator::free(Allocation& allocation) {
+	std::lock_guard lock(m_mutex);
+
+	auto& block = *static_cast<Block*>(allocation.m_block);
+	block.used -= allocation.m_size;
+	block.allocation_count--;
+
+	vk::DeviceSize offset = allocation.m_offset;
+	vk::DeviceSize size = allocation.m_size;
+
+	// Coalesce with the neighbouring free ranges
+	auto next = block.free_by_offset.lower_bound(offset);
+	if (next != block.free_by_offset.begin()) {
+		const auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			block.erase_free(prev);
+		}
+	}
+	if (next != block.free_by_offset.end() && next->first == offset + size) {
+		size += next->second;
+		block.erase_free(next);
+	}
+	block.insert_free(offset, size);
+
+	if (block.allocation_count == 0) {
+		auto& blocks = m_blocks[block.memory_type];
+		if (block.size != m_block_size || blocks.size() > 1) {
+			std::erase_if(blocks, [&](const auto& b) { return b.get() == &block; });
+		}
+	}
+}
+
+bool Allocator::allocate_from(
+	Block& block,
+	const vk::DeviceSize size,
+	const vk::DeviceSize alignment,
+	vk::DeviceSize& offset
+) {
+	// Best fit: walk the ranges from the smallest one that could hold the request
+	for (auto it = block.free_by_size.lower_bound(size); it != block.free_by_size.end(); ++it) {
+		const vk::DeviceSize range_offset = it->second;
+		const vk::DeviceSize range_size = it->first;
+		const vk::DeviceSize aligned = align_up(range_offset, alignment);
+		if (aligned + size > range_offset + range_size) {
+			continue;
+		}
+
+		block.erase_free(block.free_by_offset.find(range_offset));
+		if (aligned > range_offset) {
+			block.insert_free(range_offset, aligned - range_offset);
+		}
+		if (aligned + size < range_offset + range_size) {
+			block.insert_free(aligned + size, range_offset + range_size - aligned - size);
+		}
+
+		offset = aligned;
+		return true;
+	}
+	return false;
+}
+
+Allocator::Block& Allocator::create_block(const u32 memory_type, const vk::DeviceSize size) {
+	auto block = std::make_unique<Block>();
+	block->memory = vk::raii::DeviceMemory(
+		m_device.device(),
+		vk::MemoryAllocateInfo().setAllocationSize(size).setMemoryTypeIndex(memory_type)
+	);
+	block->size = size;
+	block->memory_type = memory_type;
+	block->insert_free(0, size);
+
+	if (m_memory_properties.memoryTypes[memory_type].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+		block->mapped = block->memory.mapMemory(0, VK_WHOLE_SIZE);
+	}
+
+	VX_DEBUG("Allocated device memory block ({} bytes, type {})", size, memory_type);
+
+	m_blocks[memory_type].push_back(std::move(block));
+	return *m_blocks[memory_type].back();
+}
+
+void Allocator::accumulate(const Block& block, Statistics& stats) const {
+	stats.block_count++;
+	stats.allocation_count += block.allocation_count;
+	stats.free_range_count += static_cast<u32>(block.free_by_offset.size());
+	stats.bytes_reserved += block.size;
+	stats.bytes_used += block.used;
+	if (!block.free_by_size.empty()) {
+		stats.largest_free_range = std::max(stats.largest_free_range, block.free_by_size.rbegin()->first);
+	}
+}
+
+Allocator::Statistics Allocator::statistics() const {
+	std::lock_guard lock(m_mutex);
+	Statistics stats;
+	for (const auto& blocks : m_blocks) {
+		for (const auto& block : blocks) {
+			accumulate(*block, stats);
+		}
+	}
+	return stats;
+}
+
+Allocator::Statistics Allocator::statistics(const u32 memory_type) const {
+	std::lock_guard lock(m_mutex);
+	Statistics stats;
+	for (const auto& block : m_blocks[memory_type]) {
+		accumulate(*block, stats);
+	}
+	return stats;
+}
+
+u32 Allocator::find_memory_type(const u32 type_filter, const vk::MemoryPropertyFlags properties) const {
+	for (u32 i = 0; i < m_memory_properties.memoryTypeCount; i++) {
+		if ((type_filter & (1 << i)) && (m_memory_properties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+	throw std::runtime_error("Failed to find suitable memory type");
+}
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/bindless.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Vulxels::GFX;
+
+u32 BindlessTable::Slots::acquire() {
+	if (!free.empty()) {
+		const u32 index = free.back();
+		free.pop_back();
+		return index;
+	}
+	if (next == capacity) {
+		throw std::runtime_error("Bindless table is full");
+	}
+	return next++;
+}
+
+void BindlessTable::Slots::release(const u32 index) {
+	released.push_back(index);
+}
+
+void BindlessTable::Slots::retire(const u64 frame) {
+	for (const u32 index : released) {
+		retired.emplace_back(frame, index);
+	}
+	released.clear();
+}
+
+void BindlessTable::Slots::recycle(const u64 completed) {
+	while (!retired.empty() && retired.front().first <= completed) {
+		free.push_back(retired.front().second);
+		retired.pop_front();
+	}
+}
+
+BindlessTable::BindlessTable(Device& device, const u32 max_images, const u32 max_buffers) :
+	m_layout(device),
+	m_pool(device) {
+	if (!device.features().bindless) {
+		throw std::runtime_error("Descriptor indexing is not supported by the device");
+	}
+
+	const auto properties = device.physical_device()
+								.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>()
+								.get<vk::PhysicalDeviceVulkan12Properties>();
+	m_images.capacity = std::min(
+		{max_images,
+		 properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		 properties.maxDescriptorSetUpdateAfterBindSampledImages}
+	);
+	m_buffers.capacity = std::min(
+		{max_buffers,
+		 properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+		 properties.maxDescriptorSetUpdateAfterBindStorageBuffers}
+	);
+	m_samplers.capacity = std::min(
+		{MAX_SAMPLERS,
+		 properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+		 properties.maxDescriptorSetUpdateAfterBindSamplers}
+	);
+
+	// Slots are filled in while frames using the set are in flight and unused
+	// ones are never written, so every binding is update-after-bind and partial
+	const auto flags = vk::DescriptorBindingFlagBits::eUpdateAfterBind
+		| vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending | vk::DescriptorBindingFlagBits::ePartiallyBound;
+	m_layout.add_binding(
+		IMAGE_BINDING,
+		vk::DescriptorType::eSampledImage,
+		vk::ShaderStageFlagBits::eAll,
+		m_images.capacity,
+		nullptr,
+		flags
+	);
+	m_layout.add_binding(
+		BUFFER_BINDING,
+		vk::DescriptorType::eStorageBuffer,
+		vk::ShaderStageFlagBits::eAll,
+		m_buffers.capacity,
+		nullptr,
+		flags
+	);
+	m_layout.add_binding(
+		SAMPLER_BINDING,
+		vk::DescriptorType::eSampler,
+		vk::ShaderStageFlagBits::eAll,
+		m_samplers.capacity,
+		nullptr,
+		flags
+	);
+	m_layout.set_flags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+	m_layout.create();
+
+	m_pool.add_pool_size(vk::DescriptorType::eSampledImage, m_images.capacity);
+	m_pool.add_pool_size(vk::DescriptorType::eStorageBuffer, m_buffers.capacity);
+	m_pool.add_pool_size(vk::DescriptorType::eSampler, m_samplers.capacity);
+	m_pool.set_max_sets(1);
+	m_pool.set_flags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
+	m_pool.create();
+	m_set.emplace(m_pool.allocate(m_layout));
+
+	VX_DEBUG(
+		"Created bindless table ({} images, {} buffers, {} samplers)",
+		m_images.capacity,
+		m_buffers.capacity,
+		m_samplers.capacity
+	);
+}
+
+u32 BindlessTable::add_image(const vk::ImageView view, const vk::ImageLayout layout) {
+	std::lock_guard lock(m_mutex);
+	const u32 index = m_images.acquire();
+	flush_if_full();
+	m_set->bind_image(IMAGE_BINDING, view, layout, nullptr, index);
+	return index;
+}
+
+void BindlessTable::update_image(const u32 index, const vk::ImageView view, const vk::ImageLayout layout) {
+	std::lock_guard lock(m_mutex);
+	flush_if_full();
+	m_set->bind_image(IMAGE_BINDING, view, layout, nullptr, index);
+}
+
+void BindlessTable::remove_image(const u32 index) {
+	// Partially bound, so the stale descriptor is left in place until reused,
+	// and it can't be rewritten while a frame in flight might still read it
+	std::lock_guard lock(m_mutex);
+	m_images.release(index);
+}
+
+u32 BindlessTable::add_buffer(const vk::raii::Buffer& buffer, const vk::DeviceSize range, const vk::DeviceSize offset) {
+	std::lock_guard lock(m_mutex);
+	const u32 index = m_buffers.acquire();
+	flush_if_full();
+	m_set->bind_storage_buffer(BUFFER_BINDING, buffer, range, offset, index);
+	return index;
+}
+
+void BindlessTable::remove_buffer(const u32 index) {
+	std::lock_guard lock(m_mutex);
+	m_buffers.release(index);
+}
+
+u32 BindlessTable::add_sampler(const vk::Sampler sampler) {
+	std::lock_guard lock(m_mutex);
+	const u32 index = m_samplers.acquire();
+	flush_if_full();
+	m_set->bind_sampler(SAMPLER_BINDING, sampler, index);
+	return index;
+}
+
+void BindlessTable::update(const u64 frame) {
+	std::lock_guard lock(m_mutex);
+	if (m_set->pending() > 0) {
+		m_set->write();
+		m_set->clear();
+	}
+	m_images.retire(frame);
+	m_buffers.retire(frame);
+}
+
+void BindlessTable::recycle(const u64 completed) {
+	std::lock_guard lock(m_mutex);
+	m_images.recycle(completed);
+	m_buffers.recycle(completed);
+}
+
+void BindlessTable::bind(
+	const vk::raii::CommandBuffer& cmd,
+	const vk::PipelineLayout layout,
+	const u32 set_index,
+	const vk::PipelineBindPoint bind_point
+) const {
+	cmd.bindDescriptorSets(bind_point, layout, set_index, m_set->set(), {});
+}
+
+void BindlessTable::flush_if_full() {
+	if (m_set->pending() == DescriptorSet::MAX_WRITES) {
+		m_set->write();
+		m_set->clear();
+	}
+}
@@ -5,7 +5,11 @@
  */
 
 #include <vulxels/gfx/buffer.h>
+#include <vulxels/gfx/staging.h>
+#include <vulxels/log.h>
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 
 using namespace Vulxels::GFX;
@@ -24,82 +28,90 @@ Buffer::Buffer(
 		m_usage |= vk::BufferUsageFlagBits::eTransferDst;
 	}
 
-	m_buffer = vk::raii::Buffer(
-		m_device.device(),
-		vk::BufferCreateInfo()
-			.setSize(m_size)
-			.setUsage(m_usage)
-			.setSharingMode(vk::SharingMode::eExclusive)
-			.setFlags(vk::BufferCreateFlagBits())
-	);
+	vk::BufferCreateInfo create;
+	create.setSize(m_size).setUsage(m_usage).setSharingMode(vk::SharingMode::eExclusive);
 
-	const auto requirements = m_buffer.getMemoryRequirements();
-	const u32 memory_type = find_memory_type(requirements.memoryTypeBits, m_properties);
+	// Uploads land on the transfer queue, share with it rather than transferring ownership
+	const std::array families = {m_device.graphics_queue().index(), m_device.transfer_queue().index()};
+	if (families[0] != families[1]) {
+		create.setSharingMode(vk::SharingMode::eConcurrent).setQueueFamilyIndices(families);
+	}
+
+	m_buffer = vk::raii::Buffer(m_device.device(), create);
 
-	m_memory = vk::raii::DeviceMemory(
-		m_device.device(),
-		vk::MemoryAllocateInfo().setAllocationSize(requirements.size).setMemoryTypeIndex(memory_type)
-	);
+	m_allocation = m_device.allocator().allocate(m_buffer.getMemoryRequirements(), m_properties);
+	m_buffer.bindMemory(m_allocation.memory(), m_allocation.offset());
+}
 
-	m_buffer.bindMemory(*m_memory, 0);
+Buffer::~Buffer() {
+	// Moved from, or never staged through the ring
+	if (!*m_buffer || (m_properties & vk::MemoryPropertyFlagBits::eHostVisible)) {
+		return;
+	}
+	auto& ring = m_device.staging();
+	if (m_staging_size != 0 && m_staging.empty()) {
+		ring.release(m_staging_ring_offset);
+	}
+	ring.cancel(*m_buffer);
 }
 
 void* Buffer::map(const vk::DeviceSize size, const vk::DeviceSize offset) {
 	if (!(m_properties & vk::MemoryPropertyFlagBits::eHostVisible)) {
-		m_staging_size = size == VK_WHOLE_SIZE ? m_size : size;
+		m_staging_size = size == VK_WHOLE_SIZE ? m_size - offset : size;
 		m_staging_offset = offset;
-		m_staging = std::make_unique<Buffer>(
-			m_device,
-			m_staging_size,
-			vk::BufferUsageFlagBits::eTransferSrc,
-			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-		);
-		return m_staging->map();
+		auto& ring = m_device.staging();
+		if (m_staging_size <= ring.capacity()) {
+			return ring.reserve(m_staging_size, m_staging_ring_offset);
+		}
+		// Too big to reserve in one piece, it's streamed through the ring on unmap
+		m_staging.resize(m_staging_size);
+		return m_staging.data();
 	} else {
-		return m_memory.mapMemory(offset, size);
+		return static_cast<u8*>(m_allocation.mapped()) + offset;
 	}
 }
 
 void Buffer::unmap() {
-	if (m_staging) {
-		m_staging->unmap();
-		const auto cmd = m_device.begin_one_time_command();
-		cmd->copyBuffer(
-			*m_staging->m_buffer,
-			m_buffer,
-			vk::BufferCopy().setSize(m_staging_size).setDstOffset(m_staging_offset)
-		);
-		m_device.end_one_time_command(cmd);
-		m_staging.reset();
-	} else {
-		m_memory.unmapMemory();
+	if (!m_staging.empty()) {
+		m_device.staging().upload(*m_buffer, m_staging.data(), m_staging_size, m_staging_offset);
+		m_staging = {};
+	} else if (!(m_properties & vk::MemoryPropertyFlagBits::eHostVisible)) {
+		m_device.staging().copy(*m_buffer, m_staging_ring_offset, m_staging_offset, m_staging_size);
 	}
+	m_staging_size = 0;
+	// Host visible memory stays mapped for the lifetime of its block
 }
 
 void Buffer::flush(const vk::DeviceSize size, const vk::DeviceSize offset) const {
-	m_device.device().flushMappedMemoryRanges(
-		{vk::MappedMemoryRange().setMemory(*m_memory).setSize(size).setOffset(offset)}
-	);
+	m_device.device().flushMappedMemoryRanges({mapped_range(size, offset)});
 }
 
 void Buffer::invalidate(const vk::DeviceSize size, const vk::DeviceSize offset) const {
-	m_device.device().invalidateMappedMemoryRanges(
-		{vk::MappedMemoryRange().setMemory(*m_memory).setSize(size).setOffset(offset)}
-	);
+	m_device.device().invalidateMappedMemoryRanges({mapped_range(size, offset)});
 }
 
-void Buffer::write(const void* data, const vk::DeviceSize size, const vk::DeviceSize offset) {
+u64 Buffer::write(const void* data, const vk::DeviceSize size, const vk::DeviceSize offset) {
+	VX_ZONE("Buffer::write");
+	if (!(m_properties & vk::MemoryPropertyFlagBits::eHostVisible)) {
+		return m_device.staging().upload(*m_buffer, data, size, offset);
+	}
 	const auto ptr = map(size, offset);
 	std::memcpy(ptr, data, size);
 	unmap();
+	return 0;
 }
 
-u32 Buffer::find_memory_type(const u32 type_filter, const vk::MemoryPropertyFlags properties) const {
-	const auto mem_props = m_device.physical_device().getMemoryProperties();
-	for (u32 i = 0; i < mem_props.memoryTypeCount; i++) {
-		if ((type_filter & (1 << i)) && (mem_props.memoryTypes[i].propertyFlags & properties) == properties) {
-			return i;
-		}
+vk::MappedMemoryRange Buffer::mapped_range(const vk::DeviceSize size, const vk::DeviceSize offset) const {
+	// The allocator keeps non-coherent allocations aligned to nonCoherentAtomSize,
+	// so rounding out to the whole allocation never touches a neighbour
+	const vk::DeviceSize atom = m_device.allocator().atom_size();
+	const vk::DeviceSize begin = offset / atom * atom;
+	vk::DeviceSize end = m_allocation.size();
+	if (size != VK_WHOLE_SIZE) {
+		end = std::min((offset + size + atom - 1) / atom * atom, end);
 	}
-	throw std::runtime_error("Failed to find suitable memory type");
+	return vk::MappedMemoryRange()
+		.setMemory(m_allocation.memory())
+		.setOffset(m_allocation.offset() + begin)
+		.setSize(end - begin);
 }
@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/chunk_renderer.h>
+#include <vulxels/gfx/renderer.h>
+#include <vulxels/log.h>
+
+#include <cstddef>
+
+using namespace Vulxels::GFX;
+
+ChunkRenderer::ChunkRenderer(
+	Renderer& renderer,
+	RenderGraph& graph,
+	const vk::Format color_format,
+	const vk::Format depth_format
+) :
+	m_renderer(renderer),
+	m_bindless(renderer.bindless()),
+	m_layout(renderer.device()),
+	m_indices(
+		renderer.device(),
+		sizeof(u32) * 6 * static_cast<vk::DeviceSize>(World::Mesher::MAX_QUADS),
+		vk::BufferUsageFlagBits::eIndexBuffer
+	) {
+	// Enough for the most quads a chunk can have, every chunk draws a prefix of it.
+	// Written once, so it's copied by a one-time command instead of holding up the
+	// staging ring, and frames wait for those before they draw.
+	auto& device = renderer.device();
+	Buffer staging(
+		device,
+		m_indices.size(),
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+	);
+	staging.write(World::Mesher::quad_indices(World::Mesher::MAX_QUADS));
+	const auto cmd = device.begin_one_time_command();
+	cmd->copyBuffer(*staging.buffer(), *m_indices.buffer(), vk::BufferCopy(0, 0, m_indices.size()));
+	device.end_one_time_command(cmd);
+	renderer.defer_destroy(std::move(staging));
+
+	auto pipeline = renderer.create_pipeline();
+	pipeline.use_default();
+	if (m_bindless) {
+		pipeline
+			.add_shader_stage(std::make_shared<Shader>(device, "voxel.vert.spv"), vk::ShaderStageFlagBits::eVertex)
+			.add_descriptor_set_layout(m_bindless->layout());
+	} else {
+		m_layout.add_binding(0, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex);
+		m_layout.create();
+		pipeline
+			.add_shader_stage(
+				std::make_shared<Shader>(device, "voxel_fallback.vert.spv"),
+				vk::ShaderStageFlagBits::eVertex
+			)
+			.add_descriptor_set_layout(m_layout);
+	}
+	pipeline
+		.add_shader_stage(std::make_shared<Shader>(device, "voxel.frag.spv"), vk::ShaderStageFlagBits::eFragment)
+		.add_push_constant_range({vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConstants)})
+		.enable_depth_test(true)
+		.enable_depth_write(true)
+		.set_depth_compare_op(vk::CompareOp::eLess);
+	if (graph.dynamic_rendering()) {
+		pipeline.set_attachment_formats({color_format}, depth_format);
+	} else {
+		pipeline.set_render_pass(
+			graph.compatible_render_pass({color_format}, depth_format),
+			{color_format},
+			depth_format
+		);
+	}
+	m_pipeline = renderer.pipelines().get_async(std::move(pipeline));
+}
+
+ChunkRenderer::~ChunkRenderer() {
+	// Frames still in flight may draw the meshes, and their indices go back to the table
+	m_meshes.for_each([&](const glm::ivec3, std::unique_ptr<Mesh>& mesh) { release(mesh); });
+}
+
+void ChunkRenderer::upload(const glm::ivec3 coord, const std::span<const World::ChunkQuad> quads) {
+	VX_ZONE("ChunkRenderer::upload");
+	if (quads.empty()) {
+		remove(coord);
+		return;
+	}
+
+	const auto size = static_cast<vk::DeviceSize>(quads.size_bytes());
+	auto mesh = std::make_unique<Mesh>(Mesh {
+		Buffer(m_renderer.device(), size, vk::BufferUsageFlagBits::eStorageBuffer),
+		BindlessTable::INVALID_INDEX,
+		static_cast<u32>(quads.size())
+	});
+	mesh->quads.write(quads);
+	if (m_bindless) {
+		mesh->index = m_bindless->add_buffer(mesh->quads.buffer(), size);
+	}
+
+	auto [slot, inserted] = m_meshes.try_emplace(coord);
+	if (!inserted) {
+		release(slot);
+	} else {
+		m_stats.chunks++;
+	}
+	m_stats.quads += mesh->count;
+	m_stats.memory += size;
+	slot = std::move(mesh);
+}
+
+void ChunkRenderer::remove(const glm::ivec3 coord) {
+	if (auto* mesh = m_meshes.find(coord)) {
+		release(*mesh);
+		m_meshes.erase(coord);
+		m_stats.chunks--;
+	}
+}
+
+void ChunkRenderer::release(std::unique_ptr<Mesh>& mesh) {
+	m_stats.quads -= mesh->count;
+	m_stats.memory -= mesh->quads.size();
+	if (mesh->index != BindlessTable::INVALID_INDEX) {
+		m_bindless->remove_buffer(mesh->index);
+	}
+	m_renderer.defer_destroy(std::move(mesh));
+}
+
+void ChunkRenderer::draw(const RenderGraph::PassContext& context, const glm::mat4& view_proj) {
+	VX_ZONE("ChunkRenderer::draw");
+	const auto pipeline = m_pipeline.get();
+	if (!pipeline) {
+		return;
+	}
+
+	m_draws.clear();
+	m_meshes.for_each([&](const glm::ivec3 coord, const std::unique_ptr<Mesh>& mesh) {
+		m_draws.emplace_back(coord * static_cast<i32>(World::Chunk::SIZE), mesh.get());
+	});
+	if (m_draws.empty()) {
+		return;
+	}
+
+	// Frame descriptors aren't thread safe, so every set is written up front
+	m_sets.clear();
+	if (!m_bindless) {
+		m_sets = m_renderer.frame_descriptors().allocate(m_layout, static_cast<u32>(m_draws.size()));
+		for (usize i = 0; i < m_draws.size(); i++) {
+			const auto& quads = m_draws[i].second->quads;
+			m_sets[i].bind_storage_buffer(0, quads.buffer(), quads.size());
+			m_sets[i].write();
+		}
+	}
+
+	const auto extent = context.extent;
+	context.cmd.executeCommands(m_renderer.record_parallel(
+		context.inheritance,
+		m_draws.size(),
+		[&](const vk::raii::CommandBuffer& cmd, const usize begin, const usize end) {
+			// Dynamic state isn't inherited, every secondary sets its own
+			cmd.setViewport(
+				0,
+				{vk::Viewport()
+					 .setX(0.0f)
+					 .setY(0.0f)
+					 .setWidth(static_cast<f32>(extent.width))
+					 .setHeight(static_cast<f32>(extent.height))
+					 .setMinDepth(0.0f)
+					 .setMaxDepth(1.0f)}
+			);
+			cmd.setScissor(0, {vk::Rect2D().setOffset({0, 0}).setExtent(extent)});
+			cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->pipeline());
+			cmd.bindIndexBuffer(m_indices.buffer(), 0, vk::IndexType::eUint32);
+
+			const auto& layout = pipeline->layout();
+			if (m_bindless) {
+				m_bindless->bind(cmd, *layout);
+			}
+			cmd.pushConstants<glm::mat4>(
+				*layout,
+				vk::ShaderStageFlagBits::eVertex,
+				offsetof(PushConstants, view_proj),
+				view_proj
+			);
+			for (usize i = begin; i < end; i++) {
+				const auto& [origin, mesh] = m_draws[i];
+				if (!m_bindless) {
+					cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *layout, 0, {m_sets[i].set()}, {});
+				}
+				cmd.pushConstants<glm::ivec4>(
+					*layout,
+					vk::ShaderStageFlagBits::eVertex,
+					offsetof(PushConstants, origin),
+					glm::ivec4(origin, static_cast<i32>(mesh->index))
+				);
+				cmd.drawIndexed(mesh->count * 6, 1, 0, 0, 0);
+			}
+		},
+		"Chunks",
+		MIN_BATCH
+	));
+}
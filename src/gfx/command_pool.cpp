@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/command_pool.h>
+#include <vulxels/gfx/device.h>
+
+using namespace Vulxels::GFX;
+
+CommandPool::CommandPool(Device& device, const u32 family, const vk::CommandBufferLevel level) :
+	m_device(device),
+	m_level(level) {
+	m_pool = vk::raii::CommandPool(
+		m_device.device(),
+		vk::CommandPoolCreateInfo()
+			.setQueueFamilyIndex(family)
+			.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient)
+	);
+}
+
+vk::raii::CommandBuffer* CommandPool::acquire(const u64 completed) {
+	// Submissions complete in order, so stop at the first one still running
+	while (!m_pending.empty() && m_pending.front().first <= completed) {
+		m_free.push_back(m_pending.front().second);
+		m_pending.pop_front();
+	}
+
+	if (m_free.empty()) {
+		vk::raii::CommandBuffers cmds(
+			m_device.device(),
+			vk::CommandBufferAllocateInfo().setCommandPool(m_pool).setLevel(m_level).setCommandBufferCount(1)
+		);
+		m_buffers.push_back(std::make_unique<vk::raii::CommandBuffer>(std::move(cmds.front())));
+		return m_buffers.back().get();
+	}
+
+	const auto cmd = m_free.back();
+	m_free.pop_back();
+	return cmd;
+}
+
+void CommandPool::release(vk::raii::CommandBuffer* cmd, const u64 value) {
+	m_pending.emplace_back(value, cmd);
+}
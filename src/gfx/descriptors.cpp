@@ -5,7 +5,12 @@
  */
 
 #include <vulxels/gfx/descriptors.h>
+#include <vulxels/hash.h>
 
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Vulxels;
 using namespace Vulxels::GFX;
 
 void DescriptorLayout::add_binding(
@@ -13,7 +18,8 @@ void DescriptorLayout::add_binding(
 	const vk::DescriptorType type,
 	const vk::ShaderStageFlags stages,
 	const u32 count,
-	const vk::Sampler* samplers
+	const vk::Sampler* samplers,
+	const vk::DescriptorBindingFlags flags
 ) {
 	m_bindings.push_back(
 		vk::DescriptorSetLayoutBinding()
@@ -23,11 +29,33 @@ void DescriptorLayout::add_binding(
 			.setStageFlags(stages)
 			.setPImmutableSamplers(samplers)
 	);
+	m_binding_flags.push_back(flags);
 }
 
 void DescriptorLayout::create() {
-	m_layout =
-		vk::raii::DescriptorSetLayout(m_device.device(), vk::DescriptorSetLayoutCreateInfo().setBindings(m_bindings));
+	vk::StructureChain<vk::DescriptorSetLayoutCreateInfo, vk::DescriptorSetLayoutBindingFlagsCreateInfo> create(
+		vk::DescriptorSetLayoutCreateInfo().setFlags(m_flags).setBindings(m_bindings),
+		vk::DescriptorSetLayoutBindingFlagsCreateInfo().setBindingFlags(m_binding_flags)
+	);
+	if (std::ranges::all_of(m_binding_flags, [](const auto flags) { return !flags; })) {
+		create.unlink<vk::DescriptorSetLayoutBindingFlagsCreateInfo>();
+	}
+	m_layout = vk::raii::DescriptorSetLayout(m_device.device(), create.get<vk::DescriptorSetLayoutCreateInfo>());
+
+	// Field by field, the bindings carry padding and a sampler pointer
+	u64 h = hash_value(m_flags);
+	for (usize i = 0; i < m_bindings.size(); i++) {
+		const auto& binding = m_bindings[i];
+		h = hash_value(binding.binding, h);
+		h = hash_value(binding.descriptorType, h);
+		h = hash_value(binding.descriptorCount, h);
+		h = hash_value(binding.stageFlags, h);
+		if (binding.pImmutableSamplers) {
+			h = hash_bytes(binding.pImmutableSamplers, binding.descriptorCount * sizeof(vk::Sampler), h);
+		}
+		h = hash_value(m_binding_flags[i], h);
+	}
+	m_hash = h;
 }
 
 void DescriptorPool::create() {
@@ -36,7 +64,7 @@ void DescriptorPool::create() {
 		vk::DescriptorPoolCreateInfo()
 			.setMaxSets(m_max_sets)
 			.setPoolSizes(m_sizes)
-			.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
+			.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet | m_flags)
 	);
 }
 
@@ -45,7 +73,114 @@ DescriptorSet DescriptorPool::allocate(DescriptorLayout& layout) const {
 		m_device.device(),
 		vk::DescriptorSetAllocateInfo().setDescriptorPool(m_pool).setSetLayouts(*layout.layout())
 	);
-	return DescriptorSet {std::move(sets.front())};
+	return DescriptorSet {m_device.device(), std::move(sets.front())};
+}
+
+std::vector<DescriptorSet> DescriptorPool::allocate(DescriptorLayout& layout, const u32 count) const {
+	const std::vector<vk::DescriptorSetLayout> layouts(count, *layout.layout());
+	auto sets = vk::raii::DescriptorSets(
+		m_device.device(),
+		vk::DescriptorSetAllocateInfo().setDescriptorPool(m_pool).setSetLayouts(layouts)
+	);
+
+	std::vector<DescriptorSet> result;
+	result.reserve(count);
+	for (auto& set : sets) {
+		result.push_back(DescriptorSet {m_device.device(), std::move(set)});
+	}
+	return result;
+}
+
+DescriptorAllocator::DescriptorAllocator(Device& device, std::vector<vk::DescriptorPoolSize> ratios) :
+	m_device(device),
+	m_ratios(std::move(ratios)) {}
+
+DescriptorSet DescriptorAllocator::allocate(DescriptorLayout& layout) {
+	vk::DescriptorSet set;
+	allocate_into(layout, 1, &set);
+	return DescriptorSet {m_device.device(), set};
+}
+
+std::vector<DescriptorSet> DescriptorAllocator::allocate(DescriptorLayout& layout, const u32 count) {
+	std::vector<vk::DescriptorSet> sets(count);
+	allocate_into(layout, count, sets.data());
+
+	std::vector<DescriptorSet> result;
+	result.reserve(count);
+	for (const auto set : sets) {
+		result.push_back(DescriptorSet {m_device.device(), set});
+	}
+	return result;
+}
+
+void DescriptorAllocator::reset() {
+	for (auto& pool : m_full) {
+		m_ready.push_back(std::move(pool));
+	}
+	m_full.clear();
+	for (auto& pool : m_ready) {
+		pool.reset();
+	}
+}
+
+vk::raii::DescriptorPool DescriptorAllocator::create_pool(const u32 sets) const {
+	std::vector<vk::DescriptorPoolSize> sizes;
+	sizes.reserve(m_ratios.size());
+	for (const auto& ratio : m_ratios) {
+		sizes.emplace_back(ratio.type, ratio.descriptorCount * sets);
+	}
+	return {m_device.device(), vk::DescriptorPoolCreateInfo().setMaxSets(sets).setPoolSizes(sizes)};
+}
+
+void DescriptorAllocator::allocate_into(DescriptorLayout& layout, const u32 count, vk::DescriptorSet* sets) {
+	const std::vector<vk::DescriptorSetLayout> layouts(count, *layout.layout());
+	const auto& device = m_device.device();
+
+	// Called through the dispatcher so running out of pool space isn't an exception
+	for (u32 attempt = 0; attempt < 2; attempt++) {
+		if (m_ready.empty()) {
+			m_ready.push_back(create_pool(std::max(m_sets_per_pool, count)));
+			m_sets_per_pool = std::min(m_sets_per_pool * 2, MAX_SETS);
+		}
+
+		const auto info = vk::DescriptorSetAllocateInfo().setDescriptorPool(m_ready.back()).setSetLayouts(layouts);
+		const auto res = device.getDispatcher()->vkAllocateDescriptorSets(
+			*device,
+			reinterpret_cast<const VkDescriptorSetAllocateInfo*>(&info),
+			reinterpret_cast<VkDescriptorSet*>(sets)
+		);
+		if (res == VK_SUCCESS) {
+			return;
+		}
+		if (res != VK_ERROR_OUT_OF_POOL_MEMORY && res != VK_ERROR_FRAGMENTED_POOL) {
+			break;
+		}
+
+		m_full.push_back(std::move(m_ready.back()));
+		m_ready.pop_back();
+	}
+	throw std::runtime_error("Failed to allocate descriptor sets");
+}
+
+DescriptorSet::DescriptorSet(const vk::raii::Device& device, vk::raii::DescriptorSet&& set) :
+	m_owned(std::move(set)),
+	m_set(*m_owned),
+	m_device(&device) {}
+
+DescriptorSet::DescriptorSet(const vk::raii::Device& device, const vk::DescriptorSet set) :
+	m_set(set),
+	m_device(&device) {}
+
+vk::WriteDescriptorSet& DescriptorSet::next_write(const u32 binding, const vk::DescriptorType type, const u32 element) {
+	if (m_count == MAX_WRITES) {
+		throw std::runtime_error("Too many pending descriptor writes");
+	}
+	return m_writes[m_count++] = vk::WriteDescriptorSet()
+									.setDstSet(m_set)
+									.setDstBinding(binding)
+									.setDstArrayElement(element)
+									.setDescriptorCount(1)
+									.setDescriptorType(type);
 }
 
 void DescriptorSet::bind_buffer(
@@ -54,17 +189,73 @@ void DescriptorSet::bind_buffer(
 	const vk::DeviceSize range,
 	const vk::DeviceSize offset
 ) {
-	m_buffer_infos.push_back(vk::DescriptorBufferInfo().setBuffer(buffer).setOffset(offset).setRange(range));
-	m_writes.push_back(
-		vk::WriteDescriptorSet()
-			.setDstSet(m_set)
-			.setDstBinding(binding)
-			.setDstArrayElement(0)
-			.setDescriptorType(vk::DescriptorType::eUniformBuffer)
-			.setBufferInfo(m_buffer_infos.back())
+	m_buffer_infos[m_count] = vk::DescriptorBufferInfo().setBuffer(buffer).setOffset(offset).setRange(range);
+	next_write(binding, vk::DescriptorType::eUniformBuffer);
+}
+
+void DescriptorSet::bind_storage_buffer(
+	const u32 binding,
+	const vk::raii::Buffer& buffer,
+	const vk::DeviceSize range,
+	const vk::DeviceSize offset,
+	const u32 element
+) {
+	m_buffer_infos[m_count] = vk::DescriptorBufferInfo().setBuffer(buffer).setOffset(offset).setRange(range);
+	next_write(binding, vk::DescriptorType::eStorageBuffer, element);
+}
+
+void DescriptorSet::bind_dynamic_buffer(
+	const u32 binding,
+	const vk::raii::Buffer& buffer,
+	const vk::DeviceSize range,
+	const vk::DescriptorType type
+) {
+	// The offset is supplied per draw through bindDescriptorSets
+	m_buffer_infos[m_count] = vk::DescriptorBufferInfo().setBuffer(buffer).setOffset(0).setRange(range);
+	next_write(binding, type);
+}
+
+void DescriptorSet::bind_image(
+	const u32 binding,
+	const vk::ImageView view,
+	const vk::ImageLayout layout,
+	const vk::Sampler sampler,
+	const u32 element
+) {
+	m_image_infos[m_count] = vk::DescriptorImageInfo().setImageView(view).setImageLayout(layout).setSampler(sampler);
+	next_write(
+		binding,
+		sampler ? vk::DescriptorType::eCombinedImageSampler : vk::DescriptorType::eSampledImage,
+		element
 	);
 }
 
+void DescriptorSet::bind_storage_image(const u32 binding, const vk::ImageView view, const u32 element) {
+	m_image_infos[m_count] = vk::DescriptorImageInfo().setImageView(view).setImageLayout(vk::ImageLayout::eGeneral);
+	next_write(binding, vk::DescriptorType::eStorageImage, element);
+}
+
+void DescriptorSet::bind_sampler(const u32 binding, const vk::Sampler sampler, const u32 element) {
+	m_image_infos[m_count] = vk::DescriptorImageInfo().setSampler(sampler);
+	next_write(binding, vk::DescriptorType::eSampler, element);
+}
+
 void DescriptorSet::write() const {
-	m_set.getDevice().updateDescriptorSets(m_writes, {});
+	std::array<vk::WriteDescriptorSet, MAX_WRITES> writes;
+	for (u32 i = 0; i < m_count; i++) {
+		writes[i] = m_writes[i];
+		switch (writes[i].descriptorType) {
+			case vk::DescriptorType::eSampler:
+			case vk::DescriptorType::eCombinedImageSampler:
+			case vk::DescriptorType::eSampledImage:
+			case vk::DescriptorType::eStorageImage:
+			case vk::DescriptorType::eInputAttachment:
+				writes[i].setPImageInfo(&m_image_infos[i]);
+				break;
+			default:
+				writes[i].setPBufferInfo(&m_buffer_infos[i]);
+				break;
+		}
+	}
+	m_device->updateDescriptorSets(vk::ArrayProxy<const vk::WriteDescriptorSet>(m_count, writes.data()), {});
 }
@@ -5,57 +5,311 @@
  */
 
 #include <vulxels/gfx/device.h>
+#include <vulxels/gfx/staging.h>
 #include <vulxels/log.h>
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cstdio>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using namespace Vulxels::GFX;
 
 static constexpr std::array DEVICE_EXTENSIONS = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
-Device::Device(Instance& instance, const Window& window) : m_instance(instance) {
+static bool has_extension(const vk::raii::PhysicalDevice& device, const std::string_view name) {
+	return std::ranges::any_of(device.enumerateDeviceExtensionProperties(), [&](const vk::ExtensionProperties& ext) {
+		return std::string_view(ext.extensionName.data()) == name;
+	});
+}
+
+// Shaders index the storage buffer array with push constants, which is dynamic indexing
+static bool
+supports_bindless(const vk::PhysicalDeviceFeatures& core, const vk::PhysicalDeviceVulkan12Features& features) {
+	return core.shaderStorageBufferArrayDynamicIndexing && features.descriptorIndexing
+		&& features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound
+		&& features.descriptorBindingSampledImageUpdateAfterBind
+		&& features.descriptorBindingStorageBufferUpdateAfterBind && features.descriptorBindingUpdateUnusedWhilePending
+		&& features.shaderSampledImageArrayNonUniformIndexing && features.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+static bool supports_dynamic_rendering(const vk::raii::PhysicalDevice& device) {
+	// Core in 1.3, but the instance only asks for 1.2 so it's used as the extension
+	if (!has_extension(device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+		return false;
+	}
+	return device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeaturesKHR>()
+		.get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>()
+		.dynamicRendering;
+}
+
+static bool supports_present_wait(const vk::raii::PhysicalDevice& device) {
+	if (!has_extension(device, VK_KHR_PRESENT_ID_EXTENSION_NAME)
+		|| !has_extension(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+		return false;
+	}
+	const auto features = device.getFeatures2<
+		vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDevicePresentIdFeaturesKHR,
+		vk::PhysicalDevicePresentWaitFeaturesKHR>();
+	return features.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId
+		&& features.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+}
+
+// The largest device local heap, in bytes
+static vk::DeviceSize device_local_memory(const vk::raii::PhysicalDevice& device) {
+	vk::DeviceSize size = 0;
+	const auto memory = device.getMemoryProperties();
+	for (u32 i = 0; i < memory.memoryHeapCount; i++) {
+		if (memory.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+			size = std::max(size, memory.memoryHeaps[i].size);
+		}
+	}
+	return size;
+}
+
+// Either an index into the device list or part of the device name, ignoring case
+static bool matches_preference(const std::string_view preferred, const usize index, const std::string_view name) {
+	// Anything that isn't a whole index, including one too long to be, is matched by name
+	usize value;
+	const auto end = preferred.data() + preferred.size();
+	const auto [ptr, error] = std::from_chars(preferred.data(), end, value);
+	if (error == std::errc() && ptr == end) {
+		return value == index;
+	}
+	const auto lower = [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); };
+	return !std::ranges::search(name, preferred, {}, lower, lower).empty();
+}
+
+Device::Device(Instance& instance, const Window& window, const std::string_view preferred) : m_instance(instance) {
 	m_surface = window.create_surface(m_instance.instance());
+	init(preferred);
+}
 
-	pick_physical_device();
+Device::Device(Instance& instance, const std::string_view preferred) : m_instance(instance) {
+	init(preferred);
+}
 
-	auto [graphics_idx, present_idx] = Queue::find_families(m_physical_device, m_surface);
+void Device::init(const std::string_view preferred) {
+	pick_physical_device(preferred);
 
-	create_logical_device({graphics_idx, present_idx});
+	const auto families = Queue::find_families(m_physical_device, m_surface);
 
-	m_graphics_queue = Queue(*this, graphics_idx);
-	m_present_queue = Queue(*this, present_idx);
+	create_logical_device({families.graphics, families.present, families.transfer, families.compute});
+
+	std::unordered_map<u32, std::shared_ptr<std::mutex>> mutexes;
+	const auto mutex = [&](const u32 family) {
+		auto& entry = mutexes[family];
+		if (!entry) {
+			entry = std::make_shared<std::mutex>();
+			m_queue_mutexes.push_back(entry);
+		}
+		return entry;
+	};
+	m_graphics_queue = Queue(*this, families.graphics, mutex(families.graphics));
+	m_present_queue = Queue(*this, families.present, mutex(families.present));
+	m_transfer_queue = Queue(*this, families.transfer, mutex(families.transfer));
+	m_compute_queue = Queue(*this, families.compute, mutex(families.compute));
+
+	if (families.transfer != families.graphics) {
+		VX_LOG("Using dedicated transfer queue family {}", families.transfer);
+	}
+	if (families.compute != families.graphics) {
+		VX_LOG("Using async compute queue family {}", families.compute);
+	}
+
+	m_allocator = std::make_unique<Allocator>(*this);
 
 	create_command_pool();
+
+	m_staging = std::make_unique<StagingRing>(*this);
+	m_pipeline_cache = std::make_unique<PipelineCache>(*this);
 }
 
-vk::raii::CommandBuffer* Device::begin_one_time_command() const {
-	vk::raii::CommandBuffers cmds(
-		m_device,
-		vk::CommandBufferAllocateInfo()
-			.setCommandPool(m_secondary_pool)
-			.setLevel(vk::CommandBufferLevel::ePrimary)
-			.setCommandBufferCount(1)
-	);
-	const auto cmd = new vk::raii::CommandBuffer(std::move(cmds.front()));
+Device::~Device() = default;
+
+void Device::wait_idle() const {
+	// Always taken in the same order, and nothing else holds more than one
+	std::vector<std::unique_lock<std::mutex>> locks;
+	locks.reserve(m_queue_mutexes.size());
+	for (const auto& mutex : m_queue_mutexes) {
+		locks.emplace_back(*mutex);
+	}
+	m_device.waitIdle();
+}
+
+vk::raii::CommandBuffer* Device::begin_one_time_command() {
+	CommandPool* pool;
+	{
+		std::lock_guard lock(m_one_time_mutex);
+		auto& entry = m_one_time_pools[std::this_thread::get_id()];
+		if (!entry) {
+			entry = std::make_unique<CommandPool>(*this, m_graphics_queue.index());
+		}
+		pool = entry.get();
+	}
+
+	// The pool itself is only ever touched by this thread
+	const auto cmd = pool->acquire(m_one_time_timeline->completed());
 	cmd->begin(vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
 	return cmd;
 }
 
-void Device::end_one_time_command(const vk::raii::CommandBuffer* cmd) const {
+u64 Device::end_one_time_command(vk::raii::CommandBuffer* cmd) {
 	cmd->end();
-	m_graphics_queue.submit(vk::SubmitInfo().setCommandBuffers({**cmd}));
-	m_graphics_queue.wait_idle();
-	delete cmd;
+
+	std::lock_guard lock(m_one_time_mutex);
+	const u64 ticket = m_one_time_timeline->value() + 1;
+	m_one_time_batch.push_back(**cmd);
+	m_one_time_pools[std::this_thread::get_id()]->release(cmd, ticket);
+	return ticket;
 }
 
-void Device::pick_physical_device() {
-	m_physical_device = m_instance.instance().enumeratePhysicalDevices().front();
-	// TODO: Select the best physical device
+u64 Device::submit_one_time_commands() {
+	VX_ZONE("Device::submit_one_time_commands");
+	std::lock_guard lock(m_one_time_mutex);
+	if (m_one_time_batch.empty()) {
+		return m_one_time_timeline->value();
+	}
+
+	const u64 value = m_one_time_timeline->next();
+	const vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> submit(
+		vk::SubmitInfo()
+			.setCommandBuffers(m_one_time_batch)
+			.setSignalSemaphores(*m_one_time_timeline->semaphore()),
+		vk::TimelineSemaphoreSubmitInfo().setSignalSemaphoreValues(value)
+	);
+	m_graphics_queue.submit(submit.get<vk::SubmitInfo>());
+	m_one_time_batch.clear();
+	return value;
+}
+
+bool Device::is_complete(const u64 ticket) const {
+	return m_one_time_timeline->is_complete(ticket);
+}
+
+void Device::wait(const u64 ticket) {
+	// Make sure the batch holding the ticket has actually been submitted
+	submit_one_time_commands();
+	m_one_time_timeline->wait(ticket);
+}
+
+void Device::pick_physical_device(const std::string_view preferred) {
+	auto devices = m_instance.instance().enumeratePhysicalDevices();
+	if (devices.empty()) {
+		throw std::runtime_error("No Vulkan devices found");
+	}
+
+	// Ranked by score and then device local memory, so the larger of two otherwise
+	// equal GPUs wins rather than whichever was enumerated first
+	std::optional<usize> best;
+	std::pair<u64, vk::DeviceSize> best_rank;
+	for (usize i = 0; i < devices.size(); i++) {
+		const auto properties = devices[i].getProperties();
+		const std::string_view name = properties.deviceName.data();
+		const auto score = rate_physical_device(devices[i]);
+		const auto memory = device_local_memory(devices[i]);
+		if (score) {
+			VX_LOG(
+				"Device {}: {} ({}), score {}, {} MiB local",
+				i,
+				name,
+				vk::to_string(properties.deviceType),
+				*score,
+				memory >> 20
+			);
+		} else {
+			VX_LOG("Device {}: {} ({}), unsuitable", i, name, vk::to_string(properties.deviceType));
+		}
+
+		if (!preferred.empty()) {
+			if (!matches_preference(preferred, i, name)) {
+				continue;
+			}
+			if (!score) {
+				throw std::runtime_error(fmt::format("Requested device \"{}\" is unsuitable", name));
+			}
+		}
+		if (score && (!best || std::pair(*score, memory) > best_rank)) {
+			best = i;
+			best_rank = {*score, memory};
+		}
+	}
+
+	if (!best) {
+		throw std::runtime_error(
+			preferred.empty() ? "No suitable Vulkan device found"
+							  : fmt::format("No Vulkan device matches \"{}\"", preferred)
+		);
+	}
+	m_physical_device = std::move(devices[*best]);
 	VX_LOG("Using physical device: {}", m_physical_device.getProperties().deviceName.data());
 }
 
+std::optional<u64> Device::rate_physical_device(const vk::raii::PhysicalDevice& device) const {
+	const auto properties = device.getProperties();
+	if (properties.apiVersion < VK_API_VERSION_1_2) {
+		return std::nullopt;
+	}
+
+	const auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+	const auto& features12 = features.get<vk::PhysicalDeviceVulkan12Features>();
+	if (!features.get<vk::PhysicalDeviceFeatures2>().features.samplerAnisotropy || !features12.timelineSemaphore) {
+		return std::nullopt;
+	}
+
+	if (*m_surface) {
+		if (!has_extension(device, VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+			|| device.getSurfaceFormatsKHR(m_surface).empty() || device.getSurfacePresentModesKHR(m_surface).empty()) {
+			return std::nullopt;
+		}
+	}
+
+	QueueFamilies families;
+	try {
+		families = Queue::find_families(device, m_surface);
+	} catch (const std::runtime_error&) {
+		return std::nullopt;
+	}
+
+	// The device type dominates, then optional features and queue topology. Equal
+	// scores are broken by device local memory, see pick_physical_device().
+	u64 score = 0;
+	switch (properties.deviceType) {
+		case vk::PhysicalDeviceType::eDiscreteGpu:
+			score += 1'000'000;
+			break;
+		case vk::PhysicalDeviceType::eIntegratedGpu:
+			score += 100'000;
+			break;
+		case vk::PhysicalDeviceType::eVirtualGpu:
+			score += 10'000;
+			break;
+		default:
+			break;
+	}
+	if (supports_bindless(features.get<vk::PhysicalDeviceFeatures2>().features, features12)) {
+		score += 40'000;
+	}
+	if (supports_dynamic_rendering(device)) {
+		score += 20'000;
+	}
+	if (families.transfer != families.graphics) {
+		score += 10'000;
+	}
+	if (families.compute != families.graphics) {
+		score += 10'000;
+	}
+
+	return score;
+}
+
 void Device::create_logical_device(const std::set<u32>& queues) {
 	std::vector<vk::DeviceQueueCreateInfo> queue_create_infos;
 
@@ -66,17 +320,68 @@ void Device::create_logical_device(const std::set<u32>& queues) {
 		);
 	}
 
-	vk::PhysicalDeviceFeatures device_features;
-	device_features.setSamplerAnisotropy(true);
+	std::vector<const char*> extensions;
+	if (!headless()) {
+		extensions.assign(DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end());
+	}
 
-	m_device = vk::raii::Device(
-		m_physical_device,
-		vk::DeviceCreateInfo()
-			.setPEnabledLayerNames(VALIDATION_LAYERS)
-			.setPEnabledExtensionNames(DEVICE_EXTENSIONS)
-			.setQueueCreateInfos(queue_create_infos)
-			.setPEnabledFeatures(&device_features)
+	vk::StructureChain<
+		vk::DeviceCreateInfo,
+		vk::PhysicalDeviceFeatures2,
+		vk::PhysicalDeviceVulkan12Features,
+		vk::PhysicalDeviceDynamicRenderingFeaturesKHR,
+		vk::PhysicalDevicePresentIdFeaturesKHR,
+		vk::PhysicalDevicePresentWaitFeaturesKHR>
+		create;
+	create.get<vk::DeviceCreateInfo>()
+		.setPEnabledLayerNames(VALIDATION_LAYERS)
+		.setQueueCreateInfos(queue_create_infos);
+	create.get<vk::PhysicalDeviceFeatures2>().features.setSamplerAnisotropy(true);
+	auto& features12 = create.get<vk::PhysicalDeviceVulkan12Features>();
+	features12.setTimelineSemaphore(true);
+
+	const auto supported =
+		m_physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+	m_features.bindless = supports_bindless(
+		supported.get<vk::PhysicalDeviceFeatures2>().features,
+		supported.get<vk::PhysicalDeviceVulkan12Features>()
 	);
+	if (m_features.bindless) {
+		create.get<vk::PhysicalDeviceFeatures2>().features.setShaderStorageBufferArrayDynamicIndexing(true);
+		features12.setDescriptorIndexing(true)
+			.setRuntimeDescriptorArray(true)
+			.setDescriptorBindingPartiallyBound(true)
+			.setDescriptorBindingSampledImageUpdateAfterBind(true)
+			.setDescriptorBindingStorageBufferUpdateAfterBind(true)
+			.setDescriptorBindingUpdateUnusedWhilePending(true)
+			.setShaderSampledImageArrayNonUniformIndexing(true)
+			.setShaderStorageBufferArrayNonUniformIndexing(true);
+	}
+
+	m_features.dynamic_rendering = supports_dynamic_rendering(m_physical_device);
+	if (m_features.dynamic_rendering) {
+		extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+		create.get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>().setDynamicRendering(true);
+		VX_DEBUG("Using dynamic rendering");
+	} else {
+		create.unlink<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+	}
+
+	// Lets the renderer measure latency up to when frames are actually presented
+	m_features.present_wait = !headless() && supports_present_wait(m_physical_device);
+	if (m_features.present_wait) {
+		extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		create.get<vk::PhysicalDevicePresentIdFeaturesKHR>().setPresentId(true);
+		create.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().setPresentWait(true);
+		VX_DEBUG("Using present wait");
+	} else {
+		create.unlink<vk::PhysicalDevicePresentIdFeaturesKHR>();
+		create.unlink<vk::PhysicalDevicePresentWaitFeaturesKHR>();
+	}
+
+	create.get<vk::DeviceCreateInfo>().setPEnabledExtensionNames(extensions);
+	m_device = vk::raii::Device(m_physical_device, create.get<vk::DeviceCreateInfo>());
 }
 
 void Device::create_command_pool() {
@@ -86,12 +391,7 @@ void Device::create_command_pool() {
 			.setQueueFamilyIndex(m_graphics_queue.index())
 			.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer)
 	);
-	m_secondary_pool = vk::raii::CommandPool(
-		m_device,
-		vk::CommandPoolCreateInfo()
-			.setQueueFamilyIndex(m_graphics_queue.index())
-			.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient)
-	);
+	m_one_time_timeline = std::make_unique<Timeline>(*this);
 }
 
 SwapchainSupportDetails Device::query_swapchain_support() const {
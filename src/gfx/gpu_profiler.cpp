@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/gpu_profiler.h>
+#include <vulxels/log.h>
+
+#include <fstream>
+#include <stdexcept>
+
+using namespace Vulxels::GFX;
+
+static constexpr u32 NO_SCOPE = ~0u;
+
+GpuProfiler::GpuProfiler(Device& device, const u32 frames) {
+	const auto families = device.physical_device().getQueueFamilyProperties();
+	const u32 valid_bits = families[device.graphics_queue().index()].timestampValidBits;
+	if (valid_bits == 0) {
+		VX_WARN("Graphics queue does not support timestamps, GPU profiling disabled");
+		return;
+	}
+	m_period = device.physical_device().getProperties().limits.timestampPeriod;
+	m_mask = valid_bits == 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+	m_frames.resize(frames);
+	for (auto& frame : m_frames) {
+		frame.pool = vk::raii::QueryPool(
+			device.device(),
+			vk::QueryPoolCreateInfo().setQueryType(vk::QueryType::eTimestamp).setQueryCount(MAX_SCOPES * 2)
+		);
+		frame.names.reserve(MAX_SCOPES);
+		frame.depths.reserve(MAX_SCOPES);
+	}
+}
+
+void GpuProfiler::begin_frame(const vk::raii::CommandBuffer& cmd, const u32 slot) {
+	if (!supported()) {
+		return;
+	}
+
+	// The slot's fence has been waited on, so its queries are done
+	m_current = &m_frames[slot];
+	if (m_current->pending) {
+		collect(*m_current);
+	}
+
+	cmd.resetQueryPool(m_current->pool, 0, MAX_SCOPES * 2);
+	m_current->names.clear();
+	m_current->depths.clear();
+	m_current->number = m_frame_number++;
+	m_current->pending = true;
+	m_depth = 0;
+	m_frame_scope = begin(cmd, "Frame");
+}
+
+void GpuProfiler::end_frame(const vk::raii::CommandBuffer& cmd) {
+	if (!m_current) {
+		return;
+	}
+	end(cmd, m_frame_scope);
+	m_current = nullptr;
+}
+
+u32 GpuProfiler::begin(const vk::raii::CommandBuffer& cmd, const std::string_view name) {
+	if (!m_current || m_current->names.size() == MAX_SCOPES) {
+		return NO_SCOPE;
+	}
+	const u32 index = static_cast<u32>(m_current->names.size());
+	m_current->names.emplace_back(name);
+	m_current->depths.push_back(m_depth++);
+	cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_current->pool, index * 2);
+	return index;
+}
+
+void GpuProfiler::end(const vk::raii::CommandBuffer& cmd, const u32 index) {
+	if (!m_current || index == NO_SCOPE) {
+		return;
+	}
+	m_depth--;
+	cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_current->pool, index * 2 + 1);
+}
+
+void GpuProfiler::collect(Frame& frame) {
+	frame.pending = false;
+	const u32 count = static_cast<u32>(frame.names.size());
+	if (count == 0) {
+		return;
+	}
+
+	// No wait flag, a frame that isn't ready yet is dropped rather than stalled on
+	const auto [result, ticks] = frame.pool.getResults<u64>(
+		0,
+		count * 2,
+		count * 2 * sizeof(u64),
+		sizeof(u64),
+		vk::QueryResultFlagBits::e64
+	);
+	if (result != vk::Result::eSuccess) {
+		return;
+	}
+
+	m_timings.clear();
+	for (u32 i = 0; i < count; i++) {
+		const u64 elapsed = ((ticks[i * 2 + 1] & m_mask) - (ticks[i * 2] & m_mask)) & m_mask;
+		m_timings.push_back({frame.names[i], frame.depths[i], static_cast<f64>(elapsed) * m_period / 1e6});
+	}
+
+	m_collected++;
+	m_history.push_back(static_cast<f32>(m_timings.front().ms));
+	m_recorded.emplace_back(frame.number, m_timings);
+	if (m_history.size() > HISTORY) {
+		m_history.pop_front();
+		m_recorded.pop_front();
+	}
+}
+
+void GpuProfiler::export_csv(const std::string& path) const {
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open GPU profile file");
+	}
+
+	file << "frame,scope,depth,ms\n";
+	for (const auto& [number, timings] : m_recorded) {
+		for (const auto& timing : timings) {
+			file << number << ',' << timing.name << ',' << timing.depth << ',' << timing.ms << '\n';
+		}
+	}
+
+	VX_LOG("Exported GPU timings for {} frames: \"{}\"", m_recorded.size(), path);
+}
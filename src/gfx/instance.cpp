@@ -12,7 +12,7 @@
 
 using namespace Vulxels::GFX;
 
-Instance::Instance() {
+Instance::Instance(const bool headless) {
 	const u32 api_version = m_context.enumerateInstanceVersion();
 
 	VX_LOG(
@@ -33,7 +33,10 @@ Instance::Instance() {
 	m_appinfo.setEngineVersion(api_version);
 	m_appinfo.setApiVersion(VK_API_VERSION_1_2);
 
-	auto extensions = Window::get_required_extensions();
+	std::span<const char* const> extensions;
+	if (!headless) {
+		extensions = Window::get_required_extensions();
+	}
 
 	// TODO: Check if extensions are supported
 	// TODO: Check if validation layers are supported
@@ -6,6 +6,9 @@
 
 #include <vulxels/gfx/pipeline.h>
 
+#include <cstring>
+
+using namespace Vulxels;
 using namespace Vulxels::GFX;
 
 Pipeline::Builder& Pipeline::Builder::use_default() {
@@ -30,25 +33,90 @@ Pipeline::Builder& Pipeline::Builder::use_default() {
 		.add_dynamic_state(vk::DynamicState::eScissor);
 }
 
+u64 Pipeline::Builder::hash() const {
+	// Hashed field by field, the create info structs carry padding and pointers
+	u64 h = FNV_OFFSET;
+	for (usize i = 0; i < shader_stages.size(); i++) {
+		h = hash_value(shader_hashes[i], h);
+		h = hash_value(shader_stages[i].stage, h);
+		h = hash_bytes(shader_stages[i].pName, std::strlen(shader_stages[i].pName), h);
+	}
+	h = hash_span<vk::VertexInputBindingDescription>(vertex_bindings, h);
+	h = hash_span<vk::VertexInputAttributeDescription>(vertex_attributes, h);
+
+	h = hash_value(input_assembly_state.topology, h);
+	h = hash_value(input_assembly_state.primitiveRestartEnable, h);
+
+	h = hash_value(viewport_state.viewportCount, h);
+	h = hash_value(viewport_state.scissorCount, h);
+	if (viewport_state.pViewports) {
+		h = hash_bytes(viewport_state.pViewports, viewport_state.viewportCount * sizeof(vk::Viewport), h);
+	}
+	if (viewport_state.pScissors) {
+		h = hash_bytes(viewport_state.pScissors, viewport_state.scissorCount * sizeof(vk::Rect2D), h);
+	}
+
+	h = hash_value(rasterization_state.depthClampEnable, h);
+	h = hash_value(rasterization_state.rasterizerDiscardEnable, h);
+	h = hash_value(rasterization_state.polygonMode, h);
+	h = hash_value(rasterization_state.cullMode, h);
+	h = hash_value(rasterization_state.frontFace, h);
+	h = hash_value(rasterization_state.depthBiasEnable, h);
+	h = hash_value(rasterization_state.depthBiasConstantFactor, h);
+	h = hash_value(rasterization_state.depthBiasClamp, h);
+	h = hash_value(rasterization_state.depthBiasSlopeFactor, h);
+	h = hash_value(rasterization_state.lineWidth, h);
+
+	h = hash_value(multisample_state.rasterizationSamples, h);
+	h = hash_value(multisample_state.sampleShadingEnable, h);
+	h = hash_value(multisample_state.minSampleShading, h);
+	if (multisample_state.pSampleMask) {
+		h = hash_value(*multisample_state.pSampleMask, h);
+	}
+	h = hash_value(multisample_state.alphaToCoverageEnable, h);
+	h = hash_value(multisample_state.alphaToOneEnable, h);
+
+	h = hash_value(depth_stencil_state.depthTestEnable, h);
+	h = hash_value(depth_stencil_state.depthWriteEnable, h);
+	h = hash_value(depth_stencil_state.depthCompareOp, h);
+	h = hash_value(depth_stencil_state.depthBoundsTestEnable, h);
+	h = hash_value(depth_stencil_state.stencilTestEnable, h);
+	h = hash_value(depth_stencil_state.front, h);
+	h = hash_value(depth_stencil_state.back, h);
+	h = hash_value(depth_stencil_state.minDepthBounds, h);
+	h = hash_value(depth_stencil_state.maxDepthBounds, h);
+
+	h = hash_span<vk::PipelineColorBlendAttachmentState>(color_blend_attachments, h);
+	h = hash_value(color_blend_state.logicOpEnable, h);
+	h = hash_value(color_blend_state.logicOp, h);
+	h = hash_value(color_blend_state.blendConstants, h);
+
+	h = hash_span<vk::DynamicState>(dynamic_states, h);
+	h = hash_span<u64>(descriptor_set_layout_hashes, h);
+	h = hash_span<vk::PushConstantRange>(push_constant_ranges, h);
+	h = hash_value(render_pass != nullptr, h);
+	h = hash_span<vk::Format>(color_formats, h);
+	h = hash_value(depth_format, h);
+	return h;
+}
+
 Pipeline::Pipeline(Device& device, Builder& builder) {
 	builder.vertex_input_state.setVertexBindingDescriptions(builder.vertex_bindings);
 	builder.vertex_input_state.setVertexAttributeDescriptions(builder.vertex_attributes);
 	builder.color_blend_state.setAttachments(builder.color_blend_attachments);
 	builder.dynamic_state.setDynamicStates(builder.dynamic_states);
 
-	// TODO: Only create a new pipeline layout if there are no existing compatible layouts
-	m_layout = vk::raii::PipelineLayout(
-		device.device(),
-		vk::PipelineLayoutCreateInfo()
-			.setSetLayouts(builder.descriptor_set_layouts)
-			.setPushConstantRanges(builder.push_constant_ranges)
+	auto& cache = device.pipeline_cache();
+	m_layout = cache.layout(
+		builder.descriptor_set_layouts,
+		builder.descriptor_set_layout_hashes,
+		builder.push_constant_ranges
 	);
 
 	// TODO: Handle base pipeline handle
 
-	m_pipeline = vk::raii::Pipeline(
-		device.device(),
-		nullptr,
+	// Without a render pass the attachment formats come from the chained rendering info
+	vk::StructureChain<vk::GraphicsPipelineCreateInfo, vk::PipelineRenderingCreateInfoKHR> create(
 		vk::GraphicsPipelineCreateInfo()
 			.setStages(builder.shader_stages)
 			.setPVertexInputState(&builder.vertex_input_state)
@@ -59,7 +127,15 @@ Pipeline::Pipeline(Device& device, Builder& builder) {
 			.setPDepthStencilState(&builder.depth_stencil_state)
 			.setPColorBlendState(&builder.color_blend_state)
 			.setPDynamicState(&builder.dynamic_state)
-			.setLayout(m_layout)
-			.setRenderPass(*builder.render_pass)
+			.setLayout(*m_layout)
+			.setRenderPass(builder.render_pass ? **builder.render_pass : vk::RenderPass()),
+		vk::PipelineRenderingCreateInfoKHR()
+			.setColorAttachmentFormats(builder.color_formats)
+			.setDepthAttachmentFormat(builder.depth_format)
 	);
+	if (builder.render_pass) {
+		create.unlink<vk::PipelineRenderingCreateInfoKHR>();
+	}
+
+	m_pipeline = vk::raii::Pipeline(device.device(), cache.cache(), create.get<vk::GraphicsPipelineCreateInfo>());
 }
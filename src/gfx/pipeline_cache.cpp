@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/device.h>
+#include <vulxels/gfx/pipeline_cache.h>
+#include <vulxels/hash.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+using namespace Vulxels;
+using namespace Vulxels::GFX;
+
+// Per user rather than the working directory, which for the run target is the source tree
+static std::filesystem::path cache_directory() {
+	const auto env = [](const char* name) -> std::optional<std::filesystem::path> {
+		const char* value = std::getenv(name);
+		return value && *value ? std::optional<std::filesystem::path>(value) : std::nullopt;
+	};
+#ifdef _WIN32
+	if (const auto base = env("LOCALAPPDATA")) {
+		return *base / "Vulxels";
+	}
+#elif defined(__APPLE__)
+	if (const auto home = env("HOME")) {
+		return *home / "Library" / "Caches" / "Vulxels";
+	}
+#else
+	if (const auto base = env("XDG_CACHE_HOME")) {
+		return *base / "vulxels";
+	}
+	if (const auto home = env("HOME")) {
+		return *home / ".cache" / "vulxels";
+	}
+#endif
+	return std::filesystem::temp_directory_path() / "vulxels";
+}
+
+PipelineCache::PipelineCache(Device& device) : m_device(device) {
+	const auto props = m_device.physical_device().getProperties();
+
+	// Key the file on everything that invalidates the driver's binaries
+	std::string uuid;
+	for (const u8 byte : props.pipelineCacheUUID) {
+		uuid += fmt::format("{:02x}", byte);
+	}
+	const auto directory = cache_directory();
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		VX_WARN("Failed to create cache directory \"{}\": {}", directory.string(), error.message());
+	}
+	const auto name = fmt::format(
+		"pipelines_{:04x}_{:04x}_{:08x}_{}.cache",
+		props.vendorID,
+		props.deviceID,
+		props.driverVersion,
+		uuid
+	);
+	m_path = (directory / name).string();
+
+	const auto data = load();
+	m_cache = vk::raii::PipelineCache(
+		m_device.device(),
+		vk::PipelineCacheCreateInfo().setInitialDataSize(data.size()).setPInitialData(data.data())
+	);
+
+	if (!data.empty()) {
+		VX_DEBUG("Loaded pipeline cache: \"{}\" ({} bytes)", m_path, data.size());
+	}
+}
+
+PipelineCache::~PipelineCache() {
+	try {
+		save();
+	} catch (const std::exception& e) {
+		VX_WARN("Failed to save pipeline cache: {}", e.what());
+	}
+}
+
+std::shared_ptr<vk::raii::PipelineLayout> PipelineCache::layout(
+	const std::span<const vk::DescriptorSetLayout> set_layouts,
+	const std::span<const u64> set_layout_hashes,
+	const std::span<const vk::PushConstantRange> push_constants
+) {
+	const u64 hash = hash_span(push_constants, hash_span(set_layout_hashes));
+
+	std::lock_guard lock(m_mutex);
+	auto& bucket = m_layouts[hash];
+	for (const auto& entry : bucket) {
+		if (std::ranges::equal(entry.set_layout_hashes, set_layout_hashes)
+			&& std::ranges::equal(entry.push_constants, push_constants)) {
+			return entry.layout;
+		}
+	}
+
+	auto layout = std::make_shared<vk::raii::PipelineLayout>(
+		m_device.device(),
+		vk::PipelineLayoutCreateInfo().setSetLayouts(set_layouts).setPushConstantRanges(push_constants)
+	);
+	bucket.push_back(
+		{{set_layout_hashes.begin(), set_layout_hashes.end()}, {push_constants.begin(), push_constants.end()}, layout}
+	);
+	return layout;
+}
+
+void PipelineCache::save() const {
+	const auto data = m_cache.getData();
+	if (data.empty()) {
+		return;
+	}
+
+	// Write then rename so a crash mid-save can't leave a truncated cache behind
+	const std::string temp = m_path + ".tmp";
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to open pipeline cache file");
+		}
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+	std::filesystem::rename(temp, m_path);
+
+	VX_DEBUG("Saved pipeline cache: \"{}\" ({} bytes)", m_path, data.size());
+}
+
+std::vector<u8> PipelineCache::load() const {
+	std::ifstream file(m_path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		return {};
+	}
+
+	std::vector<u8> data(file.tellg());
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+	// Drivers should reject foreign data themselves, but not all of them do
+	const auto props = m_device.physical_device().getProperties();
+	vk::PipelineCacheHeaderVersionOne header;
+	if (data.size() < sizeof(header)) {
+		return {};
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+	if (header.headerVersion != vk::PipelineCacheHeaderVersion::eOne || header.vendorID != props.vendorID
+		|| header.deviceID != props.deviceID || header.pipelineCacheUUID != props.pipelineCacheUUID) {
+		VX_WARN("Ignoring incompatible pipeline cache: \"{}\"", m_path);
+		return {};
+	}
+
+	return data;
+}
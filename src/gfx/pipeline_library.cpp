@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/pipeline_library.h>
+#include <vulxels/log.h>
+
+using namespace Vulxels::GFX;
+
+std::shared_ptr<Pipeline> PipelineLibrary::get(Pipeline::Builder& builder) {
+	const u64 hash = builder.hash();
+
+	std::shared_future<std::shared_ptr<Pipeline>> existing;
+	std::promise<std::shared_ptr<Pipeline>> promise;
+	{
+		std::lock_guard lock(m_mutex);
+		if (const auto it = m_pipelines.find(hash); it != m_pipelines.end()) {
+			existing = it->second;
+		} else {
+			m_pipelines.emplace(hash, promise.get_future().share());
+		}
+	}
+
+	// Might still be compiling on a worker, in which case this waits for it
+	if (existing.valid()) {
+		if (auto pipeline = existing.get()) {
+			m_hits++;
+			return pipeline;
+		}
+		// That compile failed and was evicted, try again
+		return get(builder);
+	}
+
+	m_misses++;
+	try {
+		auto pipeline = std::make_shared<Pipeline>(m_device, builder);
+		promise.set_value(pipeline);
+		return pipeline;
+	} catch (...) {
+		// Evicted before anyone waiting is woken, so they retry rather than find it again
+		evict(hash);
+		promise.set_value(nullptr);
+		throw;
+	}
+}
+
+PipelineLibrary::Handle PipelineLibrary::get_async(Pipeline::Builder&& builder) {
+	const u64 hash = builder.hash();
+
+	std::lock_guard lock(m_mutex);
+	if (const auto it = m_pipelines.find(hash); it != m_pipelines.end()) {
+		m_hits++;
+		return Handle(it->second);
+	}
+
+	m_misses++;
+	m_pending++;
+	auto state = std::make_shared<Pipeline::Builder>(std::move(builder));
+	auto job = [this, state, hash]() -> std::shared_ptr<Pipeline> {
+		VX_ZONE("Compile pipeline");
+		try {
+			auto pipeline = std::make_shared<Pipeline>(m_device, *state);
+			m_pending--;
+			return pipeline;
+		} catch (const std::exception& e) {
+			VX_ERROR("Failed to compile pipeline: {}", e.what());
+		} catch (...) {
+			VX_ERROR("Failed to compile pipeline: unknown error");
+		}
+		// Handles see null and draw with their fallback, rather than rethrowing every frame
+		evict(hash);
+		m_pending--;
+		return nullptr;
+	};
+	auto future = m_jobs.submit(std::move(job)).share();
+	m_pipelines.emplace(hash, future);
+	return Handle(future);
+}
+
+void PipelineLibrary::evict(const u64 hash) {
+	std::lock_guard lock(m_mutex);
+	m_pipelines.erase(hash);
+}
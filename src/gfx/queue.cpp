@@ -8,26 +8,30 @@
 #include <vulxels/gfx/queue.h>
 
 #include <optional>
+#include <utility>
 
 using namespace Vulxels::GFX;
 
-Queue::Queue(Device& device, const u32 index) : m_index(index) {
+Queue::Queue(Device& device, const u32 index, std::shared_ptr<std::mutex> mutex) :
+	m_index(index),
+	m_mutex(std::move(mutex)) {
 	m_queue = device.device().getQueue(index, 0);
 }
 
-std::tuple<u32, u32> Queue::find_families(const vk::raii::PhysicalDevice& device, const vk::raii::SurfaceKHR& surface) {
+QueueFamilies Queue::find_families(const vk::raii::PhysicalDevice& device, const vk::raii::SurfaceKHR& surface) {
 	std::optional<u32> graphics;
 	std::optional<u32> present;
+	std::optional<u32> transfer;
 
 	const auto queue_families = device.getQueueFamilyProperties();
 	for (u32 i = 0; i < queue_families.size(); i++) {
 		if (queue_families[i].queueFlags & vk::QueueFlagBits::eGraphics) {
 			graphics = i;
 		}
-		if (device.getSurfaceSupportKHR(i, surface)) {
+		if (*surface ? device.getSurfaceSupportKHR(i, surface) : graphics == i) {
 			present = i;
 		}
-		if (graphics == present) {
+		if (graphics && graphics == present) {
 			break;
 		}
 	}
@@ -36,5 +40,41 @@ std::tuple<u32, u32> Queue::find_families(const vk::raii::PhysicalDevice& device
 		throw std::runtime_error("Failed to find suitable queue families");
 	}
 
-	return {graphics.value(), present.value()};
+	// Prefer a transfer-only family (usually backed by a DMA engine), then anything without graphics
+	for (u32 i = 0; i < queue_families.size(); i++) {
+		const auto flags = queue_families[i].queueFlags;
+		if (!(flags & vk::QueueFlagBits::eTransfer) || (flags & vk::QueueFlagBits::eGraphics)) {
+			continue;
+		}
+		if (!(flags & vk::QueueFlagBits::eCompute)) {
+			transfer = i;
+			break;
+		}
+		if (!transfer) {
+			transfer = i;
+		}
+	}
+
+	// Async compute wants a family without graphics, ideally not shared with transfers
+	std::optional<u32> compute;
+	for (u32 i = 0; i < queue_families.size(); i++) {
+		const auto flags = queue_families[i].queueFlags;
+		if (!(flags & vk::QueueFlagBits::eCompute) || (flags & vk::QueueFlagBits::eGraphics)) {
+			continue;
+		}
+		if (i != transfer) {
+			compute = i;
+			break;
+		}
+		if (!compute) {
+			compute = i;
+		}
+	}
+
+	return {
+		graphics.value(),
+		present.value(),
+		transfer.value_or(graphics.value()),
+		compute.value_or(graphics.value())
+	};
 }
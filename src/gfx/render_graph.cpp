@@ -0,0 +1,751 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/render_graph.h>
+#include <vulxels/gfx/renderer.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace Vulxels::GFX;
+
+static constexpr vk::AccessFlags WRITE_ACCESS = vk::AccessFlagBits::eColorAttachmentWrite
+	| vk::AccessFlagBits::eDepthStencilAttachmentWrite | vk::AccessFlagBits::eShaderWrite
+	| vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eHostWrite | vk::AccessFlagBits::eMemoryWrite;
+
+static vk::ImageAspectFlags aspect_of(const vk::Format format) {
+	switch (format) {
+		case vk::Format::eD16Unorm:
+		case vk::Format::eX8D24UnormPack32:
+		case vk::Format::eD32Sfloat:
+			return vk::ImageAspectFlagBits::eDepth;
+		case vk::Format::eD16UnormS8Uint:
+		case vk::Format::eD24UnormS8Uint:
+		case vk::Format::eD32SfloatS8Uint:
+			return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+		case vk::Format::eS8Uint:
+			return vk::ImageAspectFlagBits::eStencil;
+		default:
+			return vk::ImageAspectFlagBits::eColor;
+	}
+}
+
+static bool is_depth(const vk::Format format) {
+	return !(aspect_of(format) & vk::ImageAspectFlagBits::eColor);
+}
+
+template<typename T>
+static u64 handle_key(const T handle) {
+	return reinterpret_cast<u64>(static_cast<typename T::CType>(handle));
+}
+
+RenderGraph::PassBuilder&
+RenderGraph::PassBuilder::write_color(const Handle image, const std::optional<vk::ClearColorValue> clear) {
+	std::optional<vk::ClearValue> value;
+	if (clear) {
+		value = vk::ClearValue().setColor(*clear);
+	}
+	m_graph.add_access(m_pass, image, Usage::Color, vk::PipelineStageFlagBits::eColorAttachmentOutput, value);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::write_depth(const Handle image, const std::optional<f32> clear) {
+	std::optional<vk::ClearValue> value;
+	if (clear) {
+		value = vk::ClearValue().setDepthStencil({*clear, 0});
+	}
+	m_graph.add_access(
+		m_pass,
+		image,
+		Usage::Depth,
+		vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+		value
+	);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(const Handle image, const vk::PipelineStageFlags stages) {
+	m_graph.add_access(m_pass, image, Usage::Sampled, stages);
+	return *this;
+}
+
+RenderGraph::PassBuilder&
+RenderGraph::PassBuilder::read_storage(const Handle image, const vk::PipelineStageFlags stages) {
+	m_graph.add_access(m_pass, image, Usage::StorageRead, stages);
+	return *this;
+}
+
+RenderGraph::PassBuilder&
+RenderGraph::PassBuilder::write_storage(const Handle image, const vk::PipelineStageFlags stages) {
+	m_graph.add_access(m_pass, image, Usage::StorageWrite, stages);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::copy_from(const Handle image) {
+	m_graph.add_access(m_pass, image, Usage::TransferSrc, vk::PipelineStageFlagBits::eTransfer);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::copy_to(const Handle image) {
+	m_graph.add_access(m_pass, image, Usage::TransferDst, vk::PipelineStageFlagBits::eTransfer);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::side_effect() {
+	m_graph.m_passes[m_pass].side_effect = true;
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::use_secondary_buffers() {
+	m_graph.m_passes[m_pass].secondary = true;
+	return *this;
+}
+
+RenderGraph::RenderGraph(Renderer& renderer) : m_renderer(renderer) {}
+
+RenderGraph::~RenderGraph() = default;
+
+void RenderGraph::reset() {
+	m_passes.clear();
+	m_resources.clear();
+}
+
+RenderGraph::Handle RenderGraph::create_image(const std::string_view name, const ImageDesc& desc) {
+	Resource resource;
+	resource.name = name;
+	resource.desc = desc;
+	if (resource.desc.extent.width == 0 || resource.desc.extent.height == 0) {
+		resource.desc.extent = m_renderer.swapchain().extent();
+	}
+	m_resources.push_back(std::move(resource));
+	return {static_cast<u32>(m_resources.size() - 1)};
+}
+
+RenderGraph::Handle RenderGraph::import_image(const std::string_view name, const ImportedImage& image) {
+	Resource resource;
+	resource.name = name;
+	resource.desc = {image.format, image.extent};
+	resource.imported = true;
+	resource.import = image;
+	m_resources.push_back(std::move(resource));
+	return {static_cast<u32>(m_resources.size() - 1)};
+}
+
+RenderGraph::Handle RenderGraph::import_backbuffer() {
+	// Acquiring is waited on at the colour output stage, so the first barrier
+	// on the image has to start there to chain with it
+	auto& swapchain = m_renderer.swapchain();
+	return import_image(
+		"Backbuffer",
+		{swapchain.image(),
+		 swapchain.image_view(),
+		 swapchain.format().format,
+		 swapchain.extent(),
+		 vk::ImageLayout::eUndefined,
+		 swapchain.final_layout(),
+		 vk::PipelineStageFlagBits::eColorAttachmentOutput}
+	);
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(const std::string_view name, ExecuteFunc execute) {
+	Pass pass;
+	pass.name = name;
+	pass.execute = std::move(execute);
+	m_passes.push_back(std::move(pass));
+	return {*this, static_cast<u32>(m_passes.size() - 1)};
+}
+
+void RenderGraph::add_access(
+	const u32 pass,
+	const Handle image,
+	const Usage usage,
+	const vk::PipelineStageFlags stages,
+	std::optional<vk::ClearValue> clear
+) {
+	if (!image.valid() || image.index >= m_resources.size()) {
+		throw std::invalid_argument("Invalid render graph image in pass " + m_passes[pass].name);
+	}
+
+	auto& resource = m_resources[image.index];
+	switch (usage) {
+		case Usage::Color:
+			resource.usage |= vk::ImageUsageFlagBits::eColorAttachment;
+			break;
+		case Usage::Depth:
+			resource.usage |= vk::ImageUsageFlagBits::eDepthStencilAttachment;
+			break;
+		case Usage::Sampled:
+			resource.usage |= vk::ImageUsageFlagBits::eSampled;
+			break;
+		case Usage::StorageRead:
+		case Usage::StorageWrite:
+			resource.usage |= vk::ImageUsageFlagBits::eStorage;
+			break;
+		case Usage::TransferSrc:
+			resource.usage |= vk::ImageUsageFlagBits::eTransferSrc;
+			break;
+		case Usage::TransferDst:
+			resource.usage |= vk::ImageUsageFlagBits::eTransferDst;
+			break;
+	}
+	m_passes[pass].accesses.push_back({image.index, usage, stages, clear});
+}
+
+vk::Image RenderGraph::image(const Handle handle) const {
+	const auto& resource = m_resources.at(handle.index);
+	if (resource.imported) {
+		return resource.import.image;
+	}
+	return resource.physical == INVALID_INDEX ? vk::Image() : *m_physical[resource.physical].image;
+}
+
+vk::ImageView RenderGraph::view(const Handle handle) const {
+	const auto& resource = m_resources.at(handle.index);
+	if (resource.imported) {
+		return resource.import.view;
+	}
+	return resource.physical == INVALID_INDEX ? vk::ImageView() : *m_physical[resource.physical].view;
+}
+
+void RenderGraph::execute(const vk::raii::CommandBuffer& cmd) {
+	VX_ZONE("RenderGraph::execute");
+
+	// Framebuffers holding the swapchain's old views may still be in use, the
+	// views themselves are kept alive by the swapchain for as long
+	const u64 generation = m_renderer.swapchain().generation();
+	if (generation != m_swapchain_generation) {
+		retire(false);
+		m_swapchain_generation = generation;
+	}
+
+	cull();
+	allocate_transients();
+
+	for (auto& resource : m_resources) {
+		if (resource.imported) {
+			resource.state = {resource.import.initial_layout, resource.import.initial_stages, {}};
+		} else {
+			resource.state = {};
+		}
+	}
+
+	for (u32 i = 0; i < m_passes.size(); i++) {
+		if (!m_passes[i].culled) {
+			execute_pass(cmd, m_passes[i], i);
+		}
+	}
+
+	// Hand imported images back in the layout their owner expects
+	Barriers barriers;
+	for (auto& resource : m_resources) {
+		const auto layout = resource.import.final_layout;
+		if (!resource.imported || layout == vk::ImageLayout::eUndefined || resource.state.layout == layout) {
+			continue;
+		}
+		// Anything copying out afterwards has its own barrier starting at the
+		// transfer stage, so the transition has to finish before it
+		State next {layout, vk::PipelineStageFlagBits::eBottomOfPipe, {}};
+		if (layout == vk::ImageLayout::eTransferSrcOptimal) {
+			next = {layout, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead};
+		}
+		transition(resource, next, barriers);
+	}
+	flush(cmd, barriers);
+}
+
+void RenderGraph::cull() {
+	// Walking backwards, a pass is live if it has side effects or writes an
+	// image something later depends on. Imported images are depended on by
+	// whatever comes after the graph.
+	std::vector<bool> live(m_resources.size());
+	for (usize i = 0; i < m_resources.size(); i++) {
+		live[i] = m_resources[i].imported;
+		m_resources[i].first = INVALID_INDEX;
+		m_resources[i].last = INVALID_INDEX;
+	}
+
+	m_stats.passes = static_cast<u32>(m_passes.size());
+	m_stats.culled = 0;
+	for (usize i = m_passes.size(); i-- > 0;) {
+		auto& pass = m_passes[i];
+		bool needed = pass.side_effect;
+		for (const auto& access : pass.accesses) {
+			const bool write = access.usage == Usage::Color || access.usage == Usage::Depth
+				|| access.usage == Usage::StorageWrite || access.usage == Usage::TransferDst;
+			needed = needed || (write && live[access.resource]);
+		}
+		pass.culled = !needed;
+		if (!needed) {
+			m_stats.culled++;
+			continue;
+		}
+
+		// Cleared images don't depend on what came before, anything else might
+		for (const auto& access : pass.accesses) {
+			live[access.resource] = !access.clear;
+		}
+	}
+
+	for (u32 i = 0; i < m_passes.size(); i++) {
+		if (m_passes[i].culled) {
+			continue;
+		}
+		for (const auto& access : m_passes[i].accesses) {
+			auto& resource = m_resources[access.resource];
+			resource.first = std::min(resource.first, i);
+			resource.last = resource.last == INVALID_INDEX ? i : std::max(resource.last, i);
+		}
+	}
+}
+
+void RenderGraph::allocate_transients() {
+	// Images and their memory are only rebuilt when the graph changes shape
+	std::vector<u64> signature;
+	u32 count = 0;
+	for (auto& resource : m_resources) {
+		resource.physical = INVALID_INDEX;
+		if (resource.imported || resource.first == INVALID_INDEX) {
+			continue;
+		}
+		resource.physical = count++;
+		signature.insert(
+			signature.end(),
+			{static_cast<u64>(resource.desc.format),
+			 resource.desc.extent.width,
+			 resource.desc.extent.height,
+			 static_cast<VkImageUsageFlags>(resource.usage),
+			 resource.first,
+			 resource.last}
+		);
+	}
+	if (signature == m_signature) {
+		return;
+	}
+
+	// The old images are left to the frames still using them, so resizing
+	// doesn't have to wait for the device
+	auto& device = m_renderer.device();
+	retire(true);
+	m_signature = std::move(signature);
+
+	std::vector<u32> order;
+	for (u32 i = 0; i < m_resources.size(); i++) {
+		const auto& resource = m_resources[i];
+		if (resource.physical == INVALID_INDEX) {
+			continue;
+		}
+		order.push_back(i);
+
+		auto& physical = m_physical.emplace_back();
+		physical.image = vk::raii::Image(
+			device.device(),
+			vk::ImageCreateInfo()
+				.setImageType(vk::ImageType::e2D)
+				.setFormat(resource.desc.format)
+				.setExtent({resource.desc.extent.width, resource.desc.extent.height, 1})
+				.setMipLevels(1)
+				.setArrayLayers(1)
+				.setSamples(vk::SampleCountFlagBits::e1)
+				.setTiling(vk::ImageTiling::eOptimal)
+				.setUsage(resource.usage)
+				.setSharingMode(vk::SharingMode::eExclusive)
+				.setInitialLayout(vk::ImageLayout::eUndefined)
+		);
+		physical.requirements = physical.image.getMemoryRequirements();
+	}
+
+	// Greedily hand each image, in order of first use, the closest sized slot
+	// whose previous occupants are all finished with it
+	std::ranges::sort(order, [this](const u32 a, const u32 b) { return m_resources[a].first < m_resources[b].first; });
+	for (const u32 index : order) {
+		const auto& resource = m_resources[index];
+		auto& physical = m_physical[resource.physical];
+		const auto& requirements = physical.requirements;
+
+		u32 best = INVALID_INDEX;
+		vk::DeviceSize best_waste = 0;
+		for (u32 i = 0; i < m_slots.size(); i++) {
+			const auto& slot = m_slots[i];
+			if (slot.last >= resource.first || !(slot.memory_types & requirements.memoryTypeBits)) {
+				continue;
+			}
+			const auto waste = std::max(slot.size, requirements.size) - std::min(slot.size, requirements.size);
+			if (best == INVALID_INDEX || waste < best_waste) {
+				best = i;
+				best_waste = waste;
+			}
+		}
+		if (best == INVALID_INDEX) {
+			best = static_cast<u32>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		auto& slot = m_slots[best];
+		slot.size = std::max(slot.size, requirements.size);
+		slot.alignment = std::max(slot.alignment, requirements.alignment);
+		slot.memory_types &= requirements.memoryTypeBits;
+		slot.last = resource.last;
+		physical.slot = best;
+	}
+
+	m_stats.memory = 0;
+	m_stats.unaliased_memory = 0;
+	for (auto& slot : m_slots) {
+		slot.memory = device.allocator().allocate(
+			vk::MemoryRequirements(slot.size, slot.alignment, slot.memory_types),
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			false
+		);
+		m_stats.memory += slot.size;
+	}
+
+	for (const u32 index : order) {
+		const auto& resource = m_resources[index];
+		auto& physical = m_physical[resource.physical];
+		const auto& memory = m_slots[physical.slot].memory;
+		physical.image.bindMemory(memory.memory(), memory.offset());
+		physical.view = vk::raii::ImageView(
+			device.device(),
+			vk::ImageViewCreateInfo()
+				.setImage(*physical.image)
+				.setViewType(vk::ImageViewType::e2D)
+				.setFormat(resource.desc.format)
+				.setSubresourceRange({aspect_of(resource.desc.format), 0, 1, 0, 1})
+		);
+		m_stats.unaliased_memory += physical.requirements.size;
+	}
+	m_stats.transient_images = static_cast<u32>(m_physical.size());
+	m_stats.allocations = static_cast<u32>(m_slots.size());
+
+	VX_DEBUG(
+		"Allocated {} transient images in {} allocations ({} KiB, {} KiB without aliasing)",
+		m_stats.transient_images,
+		m_stats.allocations,
+		m_stats.memory / 1024,
+		m_stats.unaliased_memory / 1024
+	);
+}
+
+void RenderGraph::execute_pass(const vk::raii::CommandBuffer& cmd, Pass& pass, const u32 index) {
+	auto& profiler = m_renderer.profiler();
+	const u32 scope = profiler.begin(cmd, pass.name);
+
+	// Colour attachments first and the depth attachment last, matching render_pass()
+	std::vector<const Access*> attachments;
+	for (const auto& access : pass.accesses) {
+		if (access.usage == Usage::Color) {
+			attachments.push_back(&access);
+		}
+	}
+	for (const auto& access : pass.accesses) {
+		if (access.usage == Usage::Depth) {
+			attachments.push_back(&access);
+		}
+	}
+
+	// Load and store ops depend on the state before this pass and who uses the
+	// image after it, so they're worked out before transitioning anything
+	std::vector<AttachmentKey> keys;
+	std::vector<vk::ImageView> views;
+	std::vector<vk::ClearValue> clears;
+	vk::Extent2D extent;
+	for (const auto* access : attachments) {
+		const auto& resource = m_resources[access->resource];
+		auto load = vk::AttachmentLoadOp::eDontCare;
+		if (access->clear) {
+			load = vk::AttachmentLoadOp::eClear;
+		} else if (resource.state.layout != vk::ImageLayout::eUndefined) {
+			load = vk::AttachmentLoadOp::eLoad;
+		}
+		const bool store = resource.imported || resource.last > index;
+		keys.push_back({
+			resource.desc.format,
+			load,
+			store ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare,
+		});
+		views.push_back(view({access->resource}));
+		clears.push_back(access->clear.value_or(vk::ClearValue()));
+
+		if (extent.width == 0) {
+			extent = resource.desc.extent;
+		} else if (extent != resource.desc.extent) {
+			throw std::runtime_error("Attachments of different sizes in pass " + pass.name);
+		}
+	}
+
+	Barriers barriers;
+	for (const auto& access : pass.accesses) {
+		State next;
+		switch (access.usage) {
+			case Usage::Color:
+				next = {
+					vk::ImageLayout::eColorAttachmentOptimal,
+					access.stages,
+					vk::AccessFlagBits::eColorAttachmentWrite
+				};
+				if (!access.clear) {
+					next.access |= vk::AccessFlagBits::eColorAttachmentRead;
+				}
+				break;
+			case Usage::Depth:
+				next = {
+					vk::ImageLayout::eDepthStencilAttachmentOptimal,
+					access.stages,
+					vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite
+				};
+				break;
+			case Usage::Sampled:
+				next = {vk::ImageLayout::eShaderReadOnlyOptimal, access.stages, vk::AccessFlagBits::eShaderRead};
+				break;
+			case Usage::StorageRead:
+				next = {vk::ImageLayout::eGeneral, access.stages, vk::AccessFlagBits::eShaderRead};
+				break;
+			case Usage::StorageWrite:
+				next = {
+					vk::ImageLayout::eGeneral,
+					access.stages,
+					vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+				};
+				break;
+			case Usage::TransferSrc:
+				next = {vk::ImageLayout::eTransferSrcOptimal, access.stages, vk::AccessFlagBits::eTransferRead};
+				break;
+			case Usage::TransferDst:
+				next = {vk::ImageLayout::eTransferDstOptimal, access.stages, vk::AccessFlagBits::eTransferWrite};
+				break;
+		}
+		transition(m_resources[access.resource], next, barriers);
+	}
+	flush(cmd, barriers);
+
+	if (keys.empty()) {
+		if (pass.execute) {
+			pass.execute({cmd, {}, extent});
+		}
+		profiler.end(cmd, scope);
+		return;
+	}
+
+	// Both keep whatever the inheritance info points at alive until the pass is done
+	vk::CommandBufferInheritanceInfo inheritance;
+	vk::CommandBufferInheritanceRenderingInfoKHR rendering_inheritance;
+	std::vector<vk::Format> color_formats;
+	if (dynamic_rendering()) {
+		std::vector<vk::RenderingAttachmentInfoKHR> colors;
+		std::optional<vk::RenderingAttachmentInfoKHR> depth;
+		vk::Format depth_format = vk::Format::eUndefined;
+		for (usize i = 0; i < keys.size(); i++) {
+			const bool depth_attachment = is_depth(keys[i].format);
+			const auto info = vk::RenderingAttachmentInfoKHR()
+								  .setImageView(views[i])
+								  .setImageLayout(
+									  depth_attachment ? vk::ImageLayout::eDepthStencilAttachmentOptimal
+													   : vk::ImageLayout::eColorAttachmentOptimal
+								  )
+								  .setLoadOp(keys[i].load)
+								  .setStoreOp(keys[i].store)
+								  .setClearValue(clears[i]);
+			if (depth_attachment) {
+				depth = info;
+				depth_format = keys[i].format;
+			} else {
+				colors.push_back(info);
+				color_formats.push_back(keys[i].format);
+			}
+		}
+		vk::RenderingFlagsKHR flags;
+		if (pass.secondary) {
+			flags = vk::RenderingFlagBitsKHR::eContentsSecondaryCommandBuffers;
+		}
+		cmd.beginRenderingKHR(
+			vk::RenderingInfoKHR()
+				.setFlags(flags)
+				.setRenderArea({{0, 0}, extent})
+				.setLayerCount(1)
+				.setColorAttachments(colors)
+				.setPDepthAttachment(depth ? &*depth : nullptr)
+		);
+		rendering_inheritance.setColorAttachmentFormats(color_formats)
+			.setDepthAttachmentFormat(depth_format)
+			.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+		inheritance.setPNext(&rendering_inheritance);
+	} else {
+		const auto pass_object = render_pass(keys);
+		const auto& target = framebuffer(*pass_object, views, extent);
+		cmd.beginRenderPass(
+			vk::RenderPassBeginInfo()
+				.setRenderPass(*pass_object)
+				.setFramebuffer(*target)
+				.setRenderArea({{0, 0}, extent})
+				.setClearValues(clears),
+			pass.secondary ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline
+		);
+		inheritance.setRenderPass(*pass_object).setSubpass(0).setFramebuffer(*target);
+	}
+
+	if (!pass.secondary) {
+		cmd.setViewport(
+			0,
+			vk::Viewport(0.0f, 0.0f, static_cast<f32>(extent.width), static_cast<f32>(extent.height), 0.0f, 1.0f)
+		);
+		cmd.setScissor(0, vk::Rect2D({0, 0}, extent));
+	}
+	if (pass.execute) {
+		pass.execute({cmd, inheritance, extent});
+	}
+	if (dynamic_rendering()) {
+		cmd.endRenderingKHR();
+	} else {
+		cmd.endRenderPass();
+	}
+	profiler.end(cmd, scope);
+}
+
+void RenderGraph::transition(Resource& resource, const State& next, Barriers& barriers) {
+	// Transient images follow whatever last used their memory, which is the
+	// image itself after its first use or the image it aliases before that
+	State* last = &resource.state;
+	if (!resource.imported) {
+		last = &m_slots[m_physical[resource.physical].slot].state;
+	}
+
+	const bool hazard =
+		resource.state.layout != next.layout || (last->access & WRITE_ACCESS) || (next.access & WRITE_ACCESS);
+	if (!hazard) {
+		// Reads after reads only need to be remembered so a later write waits for them all
+		resource.state.stages |= next.stages;
+		resource.state.access |= next.access;
+		last->stages = resource.state.stages;
+		last->access = resource.state.access;
+		return;
+	}
+
+	barriers.images.push_back(
+		vk::ImageMemoryBarrier()
+			.setSrcAccessMask(last->access & WRITE_ACCESS)
+			.setDstAccessMask(next.access)
+			.setOldLayout(resource.state.layout)
+			.setNewLayout(next.layout)
+			.setImage(resource.imported ? resource.import.image : *m_physical[resource.physical].image)
+			.setSubresourceRange({aspect_of(resource.desc.format), 0, 1, 0, 1})
+	);
+	barriers.src |= last->stages ? last->stages : vk::PipelineStageFlagBits::eTopOfPipe;
+	barriers.dst |= next.stages;
+	resource.state = next;
+	*last = next;
+}
+
+void RenderGraph::flush(const vk::raii::CommandBuffer& cmd, Barriers& barriers) const {
+	if (barriers.images.empty()) {
+		return;
+	}
+	cmd.pipelineBarrier(barriers.src, barriers.dst, {}, {}, {}, barriers.images);
+	barriers = {};
+}
+
+void RenderGraph::retire(const bool transients) {
+	Retired retired;
+	retired.framebuffers = std::exchange(m_framebuffers, {});
+	if (transients) {
+		retired.slots = std::exchange(m_slots, {});
+		retired.physical = std::exchange(m_physical, {});
+	}
+	m_renderer.defer_destroy(std::move(retired));
+}
+
+bool RenderGraph::dynamic_rendering() const {
+	return m_renderer.device().features().dynamic_rendering;
+}
+
+std::shared_ptr<vk::raii::RenderPass> RenderGraph::compatible_render_pass(
+	const std::vector<vk::Format>& colors,
+	const vk::Format depth
+) {
+	// Compatibility ignores load and store ops, so any of the variants will do
+	std::vector<AttachmentKey> keys;
+	for (const auto format : colors) {
+		keys.push_back({format, vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eStore});
+	}
+	if (depth != vk::Format::eUndefined) {
+		keys.push_back({depth, vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eStore});
+	}
+	return render_pass(keys);
+}
+
+std::shared_ptr<vk::raii::RenderPass> RenderGraph::render_pass(const std::vector<AttachmentKey>& attachments) {
+	auto& entry = m_render_passes[attachments];
+	if (entry) {
+		return entry;
+	}
+
+	// Images are already in the attachment layouts when the pass begins and the
+	// graph's barriers order everything around it, so no transitions or
+	// dependencies are needed in the pass itself
+	std::vector<vk::AttachmentDescription> descriptions;
+	std::vector<vk::AttachmentReference> colors;
+	std::optional<vk::AttachmentReference> depth;
+	for (u32 i = 0; i < attachments.size(); i++) {
+		const auto& attachment = attachments[i];
+		const auto layout = is_depth(attachment.format) ? vk::ImageLayout::eDepthStencilAttachmentOptimal
+														: vk::ImageLayout::eColorAttachmentOptimal;
+		descriptions.push_back(
+			vk::AttachmentDescription()
+				.setFormat(attachment.format)
+				.setSamples(vk::SampleCountFlagBits::e1)
+				.setLoadOp(attachment.load)
+				.setStoreOp(attachment.store)
+				.setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+				.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+				.setInitialLayout(layout)
+				.setFinalLayout(layout)
+		);
+		if (is_depth(attachment.format)) {
+			depth = vk::AttachmentReference(i, layout);
+		} else {
+			colors.emplace_back(i, layout);
+		}
+	}
+
+	const auto subpass = vk::SubpassDescription()
+							 .setPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
+							 .setColorAttachments(colors)
+							 .setPDepthStencilAttachment(depth ? &*depth : nullptr);
+	entry = std::make_shared<vk::raii::RenderPass>(
+		m_renderer.device().device(),
+		vk::RenderPassCreateInfo().setAttachments(descriptions).setSubpasses(subpass)
+	);
+	return entry;
+}
+
+vk::raii::Framebuffer& RenderGraph::framebuffer(
+	const vk::raii::RenderPass& pass,
+	const std::vector<vk::ImageView>& views,
+	const vk::Extent2D extent
+) {
+	std::vector<u64> key = {handle_key(*pass), extent.width, extent.height};
+	for (const auto view : views) {
+		key.push_back(handle_key(view));
+	}
+
+	auto it = m_framebuffers.find(key);
+	if (it == m_framebuffers.end()) {
+		it = m_framebuffers
+				 .try_emplace(
+					 std::move(key),
+					 m_renderer.device().device(),
+					 vk::FramebufferCreateInfo()
+						 .setRenderPass(*pass)
+						 .setAttachments(views)
+						 .setWidth(extent.width)
+						 .setHeight(extent.height)
+						 .setLayers(1)
+				 )
+				 .first;
+	}
+	return it->second;
+}
@@ -5,10 +5,40 @@
  */
 
 #include <vulxels/gfx/renderer.h>
+#include <vulxels/gfx/staging.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace Vulxels::GFX;
 
-Renderer::Renderer(Window& window) : m_window(window) {
+Renderer::Renderer(Window& window, const RendererConfig& config) :
+	m_window(&window),
+	m_config(config),
+	m_device(m_instance, window, config.device),
+	m_swapchain(m_device, window, config.present_mode, config.image_count) {
+	init();
+}
+
+Renderer::Renderer(const vk::Extent2D extent, const RendererConfig& config) :
+	m_window(nullptr),
+	m_config(config),
+	m_instance(true),
+	m_device(m_instance, config.device),
+	m_swapchain(m_device, extent, config.image_count) {
+	VX_LOG("Running headless ({}x{})", extent.width, extent.height);
+	init();
+}
+
+void Renderer::init() {
+	m_config.frames_in_flight = std::clamp(m_config.frames_in_flight, 1u, MAX_FRAMES_IN_FLIGHT);
+
 	m_commands = vk::raii::CommandBuffers(
 		m_device.device(),
 		vk::CommandBufferAllocateInfo()
@@ -20,42 +50,444 @@ Renderer::Renderer(Window& window) : m_window(window) {
 	m_frame_ready.reserve(MAX_FRAMES_IN_FLIGHT);
 	m_image_available.reserve(MAX_FRAMES_IN_FLIGHT);
 	m_render_finished.reserve(MAX_FRAMES_IN_FLIGHT);
+	m_frame_descriptors.reserve(MAX_FRAMES_IN_FLIGHT);
 
 	for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
 		m_frame_ready.emplace_back(m_device.device(), vk::FenceCreateInfo().setFlags(vk::FenceCreateFlagBits::eSignaled));
 		m_image_available.emplace_back(m_device.device(), vk::SemaphoreCreateInfo());
 		m_render_finished.emplace_back(m_device.device(), vk::SemaphoreCreateInfo());
+		m_frame_descriptors.emplace_back(m_device);
+	}
+
+	if (m_device.features().bindless) {
+		m_bindless = std::make_unique<BindlessTable>(m_device);
 	}
 }
 
 Renderer::~Renderer() {
+	// Running jobs may record commands or defer destruction, so they finish first
+	m_jobs.shutdown();
 	m_device.wait_idle();
+	m_deferred.clear();
+	m_deferred_pending.clear();
+}
+
+void Renderer::set_config(const RendererConfig& config) {
+	m_pending_config = config;
 }
 
 vk::raii::CommandBuffer* Renderer::begin_frame() {
-	m_device.wait_for_fence(m_frame_ready[m_current_frame]);
-	if (!m_swapchain.acquire(m_image_available[m_current_frame])) {
+	VX_ZONE("Renderer::begin_frame");
+	if (m_pending_config) {
+		apply_config(*m_pending_config);
+		m_pending_config.reset();
+	}
+
+	// Kept if the swapchain has to be recreated and the frame is tried again
+	const auto input = m_input.value_or(Clock::now());
+	poll_latency();
+	{
+		VX_ZONE("Wait for frame fence");
+		m_device.wait_for_fence(m_frame_ready[m_current_frame]);
+	}
+	m_frame_completed = std::max(m_frame_completed, m_slot_frame[m_current_frame]);
+	release_deferred();
+	if (m_bindless) {
+		m_bindless->recycle(m_frame_completed);
+	}
+	poll_latency();
+	if (!m_swapchain.acquire(m_image_available[m_current_frame], m_frame_completed)) {
 		return nullptr;
 	}
 	m_device.device().resetFences({*m_frame_ready[m_current_frame]});
+	m_frame_input = input;
+	m_frame_descriptors[m_current_frame].reset();
 	auto& cmd = m_commands[m_current_frame];
 	cmd.begin(vk::CommandBufferBeginInfo());
+	m_profiler.begin_frame(cmd, m_current_frame);
 	return &cmd;
 }
 
+void Renderer::save_frame(const std::string& path) {
+	if (!m_swapchain.can_read_back()) {
+		VX_WARN("Swapchain images can't be copied from, not saving frame");
+		return;
+	}
+	m_save_path = path;
+}
+
 void Renderer::end_frame(const vk::raii::CommandBuffer* cmd) {
+	VX_ZONE("Renderer::end_frame");
+	m_profiler.end_frame(*cmd);
+	const bool readback = !m_save_path.empty();
+	if (readback) {
+		record_readback(*cmd);
+	}
 	cmd->end();
-	constexpr vk::PipelineStageFlags wait_stages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-	m_device.graphics_queue().submit(
+
+	// Indices removed while this frame was recorded may be read by it
+	if (m_bindless) {
+		m_bindless->update(m_frame_number + 1);
+	}
+
+	// Uploads queued this frame go out on the transfer queue, the frame waits for
+	// them on the GPU instead of the CPU blocking. One-time commands share the
+	// graphics queue but are only ordered with the frame by their timeline.
+	auto& uploads = m_device.staging();
+	const u64 upload_value = uploads.flush();
+	const u64 one_time_value = m_device.submit_one_time_commands();
+
+	const std::array wait_semaphores = {
+		*uploads.timeline().semaphore(),
+		*m_device.one_time_timeline().semaphore(),
+		*m_image_available[m_current_frame]
+	};
+	const std::array<vk::PipelineStageFlags, 3> wait_stages = {
+		vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput
+			| vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader
+			| vk::PipelineStageFlagBits::eComputeShader,
+		vk::PipelineStageFlagBits::eAllCommands,
+		vk::PipelineStageFlagBits::eColorAttachmentOutput
+	};
+	const std::array<u64, 3> wait_values = {upload_value, one_time_value, 0};
+
+	// Headless frames have no acquire to wait for and nothing to present, the
+	// fence alone paces them
+	const u32 wait_count = headless() ? 2 : 3;
+	vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> submit(
 		vk::SubmitInfo()
 			.setCommandBuffers(**cmd)
-			.setWaitSemaphores(*m_image_available[m_current_frame])
-			.setWaitDstStageMask(wait_stages)
-			.setSignalSemaphores(*m_render_finished[m_current_frame]),
-		*m_frame_ready[m_current_frame]
+			.setWaitSemaphoreCount(wait_count)
+			.setPWaitSemaphores(wait_semaphores.data())
+			.setPWaitDstStageMask(wait_stages.data()),
+		vk::TimelineSemaphoreSubmitInfo()
+			.setWaitSemaphoreValueCount(wait_count)
+			.setPWaitSemaphoreValues(wait_values.data())
+	);
+	if (!headless()) {
+		submit.get<vk::SubmitInfo>().setSignalSemaphores(*m_render_finished[m_current_frame]);
+	}
+	m_device.graphics_queue().submit(submit.get<vk::SubmitInfo>(), *m_frame_ready[m_current_frame]);
+	m_slot_frame[m_current_frame] = ++m_frame_number;
+	{
+		std::lock_guard lock(m_deferred_mutex);
+		if (!m_deferred_pending.empty()) {
+			m_deferred.emplace_back(m_frame_number, std::exchange(m_deferred_pending, {}));
+		}
+	}
+
+	// A frame whose present recreated the swapchain won't be sampled, its id
+	// belongs to the swapchain that was replaced
+	if (m_swapchain.present(m_render_finished[m_current_frame], m_frame_number)) {
+		m_latency_samples.push_back({m_frame_number, m_frame_input});
+	}
+	m_input.reset();
+	poll_latency();
+
+	if (readback) {
+		m_device.wait_for_fence(m_frame_ready[m_current_frame]);
+		write_readback();
+	}
+
+	m_current_frame = (m_current_frame + 1) % m_config.frames_in_flight;
+	limit_frame_rate();
+}
+
+void Renderer::apply_config(const RendererConfig& config) {
+	const u32 frames = std::clamp(config.frames_in_flight, 1u, MAX_FRAMES_IN_FLIGHT);
+	if (frames != m_config.frames_in_flight) {
+		// Slots beyond the new count may still be in flight, drain them before
+		// the frame index wraps differently
+		m_device.wait_idle();
+		m_frame_completed = m_frame_number;
+		m_current_frame = 0;
+	}
+	m_config = config;
+	m_config.frames_in_flight = frames;
+	m_swapchain.set_present_mode(m_config.present_mode);
+	m_swapchain.set_image_count(m_config.image_count);
+	m_next_frame = Clock::now();
+
+	// Frames recorded with the old config would dominate the average for a while
+	reset_latency();
+}
+
+void Renderer::poll_latency() {
+	// Present mode and image count changes only apply once the swapchain is recreated
+	if (m_swapchain.generation() != m_latency_generation) {
+		reset_latency();
+	}
+
+	// Completion is only observed when this is called, a few times a frame
+	const auto now = Clock::now();
+	while (!m_latency_samples.empty()) {
+		const auto& sample = m_latency_samples.front();
+		const bool done = latency_to_present() ? m_swapchain.presented(sample.frame) : frame_finished(sample.frame);
+		if (!done) {
+			break;
+		}
+		const f32 ms = std::chrono::duration<f32, std::milli>(now - sample.input).count();
+		m_latency = m_latency == 0.0f ? ms : m_latency + (ms - m_latency) * 0.05f;
+		m_latency_samples.pop_front();
+	}
+}
+
+void Renderer::reset_latency() {
+	m_latency_samples.clear();
+	m_latency = 0.0f;
+	m_latency_generation = m_swapchain.generation();
+}
+
+bool Renderer::frame_finished(const u64 frame) const {
+	if (frame <= m_frame_completed) {
+		return true;
+	}
+	for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		if (m_slot_frame[i] == frame) {
+			return m_frame_ready[i].getStatus() == vk::Result::eSuccess;
+		}
+	}
+	return true;
+}
+
+void Renderer::release_deferred() {
+	VX_ZONE("Renderer::release_deferred");
+	while (!m_deferred.empty() && m_deferred.front().first <= m_frame_completed) {
+		m_deferred.pop_front();
+	}
+}
+
+void Renderer::limit_frame_rate() {
+	if (m_config.frame_limit <= 0.0f) {
+		return;
+	}
+
+	// Sleeping after present rather than before acquire means the next frame
+	// polls input as late as possible
+	const auto period =
+		std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(1.0 / m_config.frame_limit));
+	const auto now = Clock::now();
+	if (m_next_frame > now) {
+		VX_ZONE("Frame limiter");
+		std::this_thread::sleep_until(m_next_frame);
+	}
+	m_next_frame = std::max(m_next_frame, now) + period;
+}
+
+void Renderer::record_readback(const vk::raii::CommandBuffer& cmd) {
+	const auto extent = m_swapchain.extent();
+	const vk::DeviceSize size = static_cast<vk::DeviceSize>(extent.width) * extent.height * 4;
+	if (!m_readback || m_readback->size() != size) {
+		m_readback = std::make_unique<Buffer>(
+			m_device,
+			size,
+			vk::BufferUsageFlagBits::eTransferDst,
+			vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+	}
+
+	const auto image = m_swapchain.image();
+	const auto layout = m_swapchain.final_layout();
+	const vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+
+	if (layout != vk::ImageLayout::eTransferSrcOptimal) {
+		cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::PipelineStageFlagBits::eTransfer,
+			{},
+			{},
+			{},
+			vk::ImageMemoryBarrier()
+				.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+				.setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+				.setOldLayout(layout)
+				.setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+				.setImage(image)
+				.setSubresourceRange(range)
+		);
+	} else {
+		cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::PipelineStageFlagBits::eTransfer,
+			{},
+			vk::MemoryBarrier()
+				.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+				.setDstAccessMask(vk::AccessFlagBits::eTransferRead),
+			{},
+			{}
+		);
+	}
+
+	cmd.copyImageToBuffer(
+		image,
+		vk::ImageLayout::eTransferSrcOptimal,
+		m_readback->buffer(),
+		vk::BufferImageCopy()
+			.setImageSubresource({vk::ImageAspectFlagBits::eColor, 0, 0, 1})
+			.setImageExtent({extent.width, extent.height, 1})
 	);
-	m_swapchain.present(m_render_finished[m_current_frame]);
-	m_current_frame = (m_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+	if (layout != vk::ImageLayout::eTransferSrcOptimal) {
+		cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eBottomOfPipe,
+			{},
+			{},
+			{},
+			vk::ImageMemoryBarrier()
+				.setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
+				.setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
+				.setNewLayout(layout)
+				.setImage(image)
+				.setSubresourceRange(range)
+		);
+	}
+}
+
+void Renderer::write_readback() {
+	const auto path = std::exchange(m_save_path, {});
+	const auto extent = m_swapchain.extent();
+	const auto format = m_swapchain.format().format;
+	const bool bgr = format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+	if (!bgr && format != vk::Format::eR8G8B8A8Unorm && format != vk::Format::eR8G8B8A8Srgb) {
+		VX_WARN("Can't save frames in format {}", vk::to_string(format));
+		return;
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		VX_ERROR("Failed to open frame file: \"{}\"", path);
+		return;
+	}
+
+	// Binary PPM, which is just a header and tightly packed RGB
+	file << "P6\n" << extent.width << ' ' << extent.height << "\n255\n";
+	const auto* pixels = static_cast<const u8*>(m_readback->map());
+	std::vector<u8> row(static_cast<usize>(extent.width) * 3);
+	for (u32 y = 0; y < extent.height; y++) {
+		for (u32 x = 0; x < extent.width; x++) {
+			const u8* pixel = pixels + (static_cast<usize>(y) * extent.width + x) * 4;
+			row[x * 3 + 0] = pixel[bgr ? 2 : 0];
+			row[x * 3 + 1] = pixel[1];
+			row[x * 3 + 2] = pixel[bgr ? 0 : 2];
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+	}
+	m_readback->unmap();
+
+	VX_LOG("Saved frame: \"{}\"", path);
+}
+
+bool Renderer::bind_pipeline(
+	const vk::raii::CommandBuffer& cmd,
+	const PipelineLibrary::Handle& handle,
+	const std::shared_ptr<Pipeline>& fallback
+) const {
+	auto pipeline = handle.get();
+	if (!pipeline) {
+		pipeline = fallback;
+	}
+	if (!pipeline) {
+		return false;
+	}
+	cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->pipeline());
+	return true;
+}
+
+vk::raii::CommandBuffer* Renderer::begin_secondary(const vk::CommandBufferInheritanceInfo& inheritance) {
+	CommandPool* pool;
+	{
+		std::lock_guard lock(m_secondary_mutex);
+		auto& entry = m_secondary_pools[std::this_thread::get_id()];
+		if (!entry) {
+			entry = std::make_unique<CommandPool>(
+				m_device,
+				m_device.graphics_queue().index(),
+				vk::CommandBufferLevel::eSecondary
+			);
+		}
+		pool = entry.get();
+	}
+
+	// Released straight away, it can't be handed out again until this frame completes
+	const auto cmd = pool->acquire(m_frame_completed);
+	pool->release(cmd, m_frame_number + 1);
+	cmd->begin(
+		vk::CommandBufferBeginInfo()
+			.setFlags(
+				vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+			)
+			.setPInheritanceInfo(&inheritance)
+	);
+	return cmd;
+}
+
+std::vector<vk::CommandBuffer> Renderer::record_parallel(
+	const vk::CommandBufferInheritanceInfo& inheritance,
+	const usize count,
+	const RecordFunc& func,
+	const std::string_view scope,
+	const usize min_batch
+) {
+	VX_ZONE("Renderer::record_parallel");
+	std::vector<vk::CommandBuffer> buffers;
+	if (count == 0) {
+		return buffers;
+	}
+
+	// Timestamps can't go in the primary while the pass takes secondaries, so the
+	// scope opens and closes in buffers of its own either side of the batches
+	u32 scope_index = 0;
+	if (!scope.empty()) {
+		const auto cmd = begin_secondary(inheritance);
+		scope_index = m_profiler.begin(*cmd, scope);
+		cmd->end();
+		buffers.push_back(**cmd);
+	}
+
+	const usize max_batches = std::clamp(count / std::max(min_batch, usize {1}), usize {1}, m_jobs.size() + 1);
+	const usize batch_size = (count + max_batches - 1) / max_batches;
+	const usize batches = (count + batch_size - 1) / batch_size;
+
+	std::vector<vk::CommandBuffer> recorded(batches);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+	const auto record = [&](const usize batch) {
+		try {
+			const usize begin = batch * batch_size;
+			const auto cmd = begin_secondary(inheritance);
+			func(*cmd, begin, std::min(begin + batch_size, count));
+			cmd->end();
+			recorded[batch] = **cmd;
+		} catch (...) {
+			std::lock_guard lock(error_mutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+	JobSystem::Counter counter;
+	for (usize batch = 1; batch < batches; batch++) {
+		m_jobs.run([&record, batch] { record(batch); }, JobSystem::Priority::High, &counter);
+	}
+
+	// The calling thread takes the first batch and then helps with the rest, and
+	// has to see every job finish before unwinding since they reference this frame
+	record(0);
+	m_jobs.wait(counter, JobSystem::Priority::High);
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	buffers.insert(buffers.end(), recorded.begin(), recorded.end());
+
+	if (!scope.empty()) {
+		const auto cmd = begin_secondary(inheritance);
+		m_profiler.end(*cmd, scope_index);
+		cmd->end();
+		buffers.push_back(**cmd);
+	}
+	return buffers;
 }
 
 void Renderer::handle_events(const SDL_Event& event) {
@@ -5,6 +5,7 @@
  */
 
 #include <vulxels/gfx/shader.h>
+#include <vulxels/hash.h>
 #include <vulxels/log.h>
 
 #include <fstream>
@@ -26,5 +27,6 @@ void Shader::load_spirv(const std::string_view path) {
 
 	VX_DEBUG("Loaded shader: \"{}\" ({} bytes)", path.data(), code.size());
 
+	m_hash = Vulxels::hash_span(std::span<const u32>(code));
 	m_module = vk::raii::ShaderModule(m_device.device(), vk::ShaderModuleCreateInfo().setCode(code));
 }
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/staging.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Vulxels::GFX;
+
+StagingRing::StagingRing(Device& device, const vk::DeviceSize capacity) :
+	m_device(device),
+	m_timeline(device),
+	m_buffer(
+		device,
+		capacity,
+		vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+	),
+	m_capacity(capacity),
+	m_pool(device, device.transfer_queue().index()) {
+	m_mapped = static_cast<u8*>(m_buffer.map());
+}
+
+StagingRing::~StagingRing() {
+	wait_idle();
+}
+
+void* StagingRing::reserve(const vk::DeviceSize size, vk::DeviceSize& offset) {
+	std::lock_guard lock(m_mutex);
+	const u64 start = m_head;
+	void* ptr = reserve_locked(size, offset);
+	// Where the reservation begins, or somewhere before it if alignment skipped ahead
+	m_open.push_back({offset, start});
+	return ptr;
+}
+
+void StagingRing::release(const vk::DeviceSize offset) {
+	std::lock_guard lock(m_mutex);
+	close(offset);
+}
+
+u64 StagingRing::copy(
+	const vk::Buffer dst,
+	const vk::DeviceSize src_offset,
+	const vk::DeviceSize dst_offset,
+	const vk::DeviceSize size
+) {
+	std::lock_guard lock(m_mutex);
+	close(src_offset);
+	m_pending.push_back({dst, vk::BufferCopy().setSrcOffset(src_offset).setDstOffset(dst_offset).setSize(size)});
+	return m_timeline.value() + 1;
+}
+
+u64 StagingRing::upload(const vk::Buffer dst, const void* data, const vk::DeviceSize size, vk::DeviceSize dst_offset) {
+	VX_ZONE("StagingRing::upload");
+	std::lock_guard lock(m_mutex);
+
+	// Anything bigger than half the ring is streamed through in pieces
+	const auto* src = static_cast<const u8*>(data);
+	vk::DeviceSize remaining = size;
+	while (remaining > 0) {
+		const vk::DeviceSize chunk = std::min(remaining, m_capacity / 2);
+		vk::DeviceSize offset;
+		std::memcpy(reserve_locked(chunk, offset), src, chunk);
+		m_pending.push_back({dst, vk::BufferCopy().setSrcOffset(offset).setDstOffset(dst_offset).setSize(chunk)});
+		src += chunk;
+		dst_offset += chunk;
+		remaining -= chunk;
+	}
+	return m_timeline.value() + 1;
+}
+
+void StagingRing::cancel(const vk::Buffer dst) {
+	std::lock_guard lock(m_mutex);
+	std::erase_if(m_pending, [dst](const Copy& copy) {
+		return copy.dst == dst;
+	});
+}
+
+u64 StagingRing::flush() {
+	VX_ZONE("StagingRing::flush");
+	std::lock_guard lock(m_mutex);
+	return flush_locked();
+}
+
+void StagingRing::wait_idle() {
+	std::lock_guard lock(m_mutex);
+	reclaim(true);
+}
+
+void* StagingRing::reserve_locked(const vk::DeviceSize size, vk::DeviceSize& offset) {
+	if (size > m_capacity) {
+		throw std::runtime_error("Staging reservation larger than the ring");
+	}
+
+	while (true) {
+		u64 start = (m_head + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+		if (start % m_capacity + size > m_capacity) {
+			// Don't straddle the end of the buffer, skip to the start instead
+			start = (start / m_capacity + 1) * m_capacity;
+		}
+		if (start + size - m_tail <= m_capacity) {
+			m_head = start + size;
+			offset = start % m_capacity;
+			return m_mapped + offset;
+		}
+
+		reclaim(false);
+		if (start + size - m_tail <= m_capacity) {
+			continue;
+		}
+
+		// Still full, so the space must be held by copies not yet submitted or finished
+		if (!m_pending.empty()) {
+			flush_locked();
+		}
+		if (m_in_flight.empty()) {
+			throw std::runtime_error("Staging ring exhausted by outstanding reservations");
+		}
+		m_timeline.wait(m_in_flight.front().value);
+		reclaim(false);
+	}
+}
+
+void StagingRing::close(const vk::DeviceSize offset) {
+	const auto it = std::ranges::find(m_open, offset, &Reservation::offset);
+	if (it != m_open.end()) {
+		m_open.erase(it);
+	}
+}
+
+u64 StagingRing::flush_locked() {
+	if (m_pending.empty()) {
+		return m_timeline.value();
+	}
+
+	// Group the regions by destination so each buffer gets one copy command
+	std::stable_sort(m_pending.begin(), m_pending.end(), [](const Copy& a, const Copy& b) {
+		return a.dst < b.dst;
+	});
+
+	auto& cmd = *m_pool.acquire(m_timeline.completed());
+	cmd.begin(vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+	std::vector<vk::BufferCopy> regions;
+	for (usize i = 0; i < m_pending.size();) {
+		regions.clear();
+		const vk::Buffer dst = m_pending[i].dst;
+		for (; i < m_pending.size() && m_pending[i].dst == dst; i++) {
+			regions.push_back(m_pending[i].region);
+		}
+		cmd.copyBuffer(*m_buffer.buffer(), dst, regions);
+	}
+	cmd.end();
+
+	// No barrier needed, consumers wait on the timeline which makes the writes visible
+	const u64 value = m_timeline.next();
+	const vk::StructureChain<vk::SubmitInfo, vk::TimelineSemaphoreSubmitInfo> submit(
+		vk::SubmitInfo().setCommandBuffers(*cmd).setSignalSemaphores(*m_timeline.semaphore()),
+		vk::TimelineSemaphoreSubmitInfo().setSignalSemaphoreValues(value)
+	);
+	m_device.transfer_queue().submit(submit.get<vk::SubmitInfo>());
+	m_pool.release(&cmd, value);
+
+	// Space still reserved for a copy not yet recorded is only freed by a later flush
+	u64 end = m_head;
+	for (const auto& reservation : m_open) {
+		end = std::min(end, reservation.start);
+	}
+	m_in_flight.push_back({value, end});
+	m_pending.clear();
+	return value;
+}
+
+void StagingRing::reclaim(const bool wait) {
+	while (!m_in_flight.empty()) {
+		auto& front = m_in_flight.front();
+		if (wait) {
+			m_timeline.wait(front.value);
+		} else if (!m_timeline.is_complete(front.value)) {
+			break;
+		}
+		m_tail = front.end;
+		m_in_flight.pop_front();
+	}
+}
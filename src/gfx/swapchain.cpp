@@ -9,12 +9,32 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
 #include <limits>
+#include <utility>
 
 using namespace Vulxels::GFX;
 
-Swapchain::Swapchain(Device& device, Window& window) : m_device(device), m_window(window) {
+template<typename T>
+static void move_into(std::vector<T>& retired, std::vector<T>& current) {
+	std::ranges::move(current, std::back_inserter(retired));
+	current.clear();
+}
+
+Swapchain::Swapchain(
+	Device& device,
+	Window& window,
+	const vk::PresentModeKHR preferred_mode,
+	const u32 preferred_image_count
+) :
+	m_device(device),
+	m_window(&window),
+	m_preferred_mode(preferred_mode),
+	m_preferred_image_count(preferred_image_count) {
 	auto support = m_device.query_swapchain_support();
+	if (support.capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc) {
+		m_usage |= vk::ImageUsageFlagBits::eTransferSrc;
+	}
 	choose_format(support.formats);
 	choose_present_mode(support.present_modes);
 	choose_image_count(support.capabilities);
@@ -24,28 +44,71 @@ Swapchain::Swapchain(Device& device, Window& window) : m_device(device), m_windo
 	create_image_views();
 }
 
-void Swapchain::set_render_pass(const std::shared_ptr<vk::raii::RenderPass>& pass) {
-	// TODO: don't recreate framebuffers if render pass is compatible
-	m_render_pass = pass;
-	create_framebuffers();
+Swapchain::Swapchain(Device& device, const vk::Extent2D extent, const u32 image_count) :
+	m_device(device),
+	m_preferred_mode(vk::PresentModeKHR::eFifo),
+	m_preferred_image_count(image_count),
+	m_usage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc),
+	m_format(vk::Format::eB8G8R8A8Unorm, vk::ColorSpaceKHR::eSrgbNonlinear),
+	m_present_mode(vk::PresentModeKHR::eFifo),
+	m_extent(extent),
+	m_image_count(std::max(image_count, MIN_OFFSCREEN_IMAGES)) {
+	create_offscreen_images();
+	create_image_views();
 }
 
 void Swapchain::set_resized() {
 	m_resized = true;
 }
 
+void Swapchain::set_present_mode(const vk::PresentModeKHR mode) {
+	if (mode != m_preferred_mode) {
+		m_preferred_mode = mode;
+		m_settings_changed = true;
+	}
+}
+
+void Swapchain::set_image_count(const u32 count) {
+	if (count != m_preferred_image_count) {
+		m_preferred_image_count = count;
+		m_settings_changed = true;
+	}
+}
+
 void Swapchain::recreate() {
-	m_device.wait_idle();
 	m_resized = false;
+
+	if (headless()) {
+		// Only the image count can change, the extent is fixed
+		m_settings_changed = false;
+		m_image_count = std::max(m_preferred_image_count, MIN_OFFSCREEN_IMAGES);
+		if (m_image_count != m_images.size()) {
+			create_offscreen_images();
+			create_image_views();
+		}
+		return;
+	}
+
 	const auto support = m_device.query_swapchain_support();
-	if (choose_extent(support.capabilities)) {
+	const bool settings_changed = std::exchange(m_settings_changed, false);
+	if (settings_changed) {
+		choose_present_mode(support.present_modes);
+		choose_image_count(support.capabilities);
+	}
+	if (choose_extent(support.capabilities) || settings_changed) {
 		create_swapchain();
 		create_image_views();
-		create_framebuffers();
 	}
 }
 
-bool Swapchain::acquire(const vk::raii::Semaphore& signal) {
+bool Swapchain::acquire(const vk::raii::Semaphore& signal, const u64 completed) {
+	VX_ZONE("Swapchain::acquire");
+	release_retired(completed);
+	if (headless()) {
+		// Nothing to wait for, the semaphore is left unsignalled
+		m_current_image = (m_current_image + 1) % m_image_count;
+		return true;
+	}
 	try {
 		auto [res, idx] = m_swapchain.acquireNextImage(std::numeric_limits<u64>::max(), *signal);
 		m_current_image = idx;
@@ -59,12 +122,26 @@ bool Swapchain::acquire(const vk::raii::Semaphore& signal) {
 	}
 }
 
-bool Swapchain::present(const vk::raii::Semaphore& wait) {
+bool Swapchain::present(const vk::raii::Semaphore& wait, const u64 frame) {
+	VX_ZONE("Swapchain::present");
+	m_frame = frame;
+	if (headless()) {
+		if (m_settings_changed) {
+			recreate();
+		}
+		return true;
+	}
 	try {
-		const auto res = m_device.present_queue().present(
-			vk::PresentInfoKHR().setSwapchains(*m_swapchain).setImageIndices(m_current_image).setWaitSemaphores(*wait)
-		);
-		if (res == vk::Result::eSuboptimalKHR || m_resized) {
+		auto info =
+			vk::PresentInfoKHR().setSwapchains(*m_swapchain).setImageIndices(m_current_image).setWaitSemaphores(*wait);
+
+		// Frame numbers only ever grow, so they double as present ids
+		const auto present_id = vk::PresentIdKHR().setPresentIds(frame);
+		if (m_device.features().present_wait) {
+			info.setPNext(&present_id);
+		}
+		const auto res = m_device.present_queue().present(info);
+		if (res == vk::Result::eSuboptimalKHR || m_resized || m_settings_changed) {
 			recreate();
 			return false;
 		}
@@ -75,6 +152,30 @@ bool Swapchain::present(const vk::raii::Semaphore& wait) {
 	return true;
 }
 
+bool Swapchain::presented(const u64 frame) const {
+	try {
+		return m_swapchain.waitForPresent(frame, 0) != vk::Result::eTimeout;
+	} catch (const vk::SystemError&) {
+		// Out of date or lost, it won't be presented now so don't wait on it
+		return true;
+	}
+}
+
+Swapchain::Retired& Swapchain::retire() {
+	// Anything replaced while recording or presenting a frame may be in use up
+	// to that frame, so everything replaced then shares an entry
+	if (m_retired.empty() || m_retired.back().frame != m_frame) {
+		m_retired.emplace_back().frame = m_frame;
+	}
+	return m_retired.back();
+}
+
+void Swapchain::release_retired(const u64 completed) {
+	while (!m_retired.empty() && m_retired.front().frame <= completed) {
+		m_retired.pop_front();
+	}
+}
+
 void Swapchain::create_swapchain() {
 	vk::SwapchainCreateInfoKHR create {};
 	create.surface = m_device.surface();
@@ -83,18 +184,13 @@ void Swapchain::create_swapchain() {
 	create.imageColorSpace = m_format.colorSpace;
 	create.imageExtent = m_extent;
 	create.imageArrayLayers = 1;
-	create.imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+	create.imageUsage = m_usage;
 	create.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
 	create.preTransform = vk::SurfaceTransformFlagBitsKHR::eIdentity;
 	create.presentMode = m_present_mode;
 	create.clipped = VK_TRUE;
-	create.oldSwapchain = nullptr;
-
-	if (*m_swapchain) {
-		create.oldSwapchain = *m_swapchain;
-	} else {
-		create.oldSwapchain = nullptr;
-	}
+	// Lets the presentation engine hand over without the old images being idle
+	create.oldSwapchain = *m_swapchain;
 
 	const std::array queue_indices = {m_device.graphics_queue().index(), m_device.present_queue().index()};
 
@@ -106,16 +202,66 @@ void Swapchain::create_swapchain() {
 		create.imageSharingMode = vk::SharingMode::eExclusive;
 	}
 
-	auto temp = vk::raii::SwapchainKHR(m_device.device(), create);
-	m_swapchain = std::move(temp);
+	auto swapchain = vk::raii::SwapchainKHR(m_device.device(), create);
+	if (*m_swapchain) {
+		retire().swapchains.push_back(std::move(m_swapchain));
+	}
+	m_swapchain = std::move(swapchain);
+
+	VX_DEBUG(
+		"Created swapchain ({}x{}, {} images, {})",
+		m_extent.width,
+		m_extent.height,
+		m_image_count,
+		vk::to_string(m_present_mode)
+	);
+}
+
+void Swapchain::create_offscreen_images() {
+	auto& retired = retire();
+	move_into(retired.offscreen_images, m_offscreen_images);
+	move_into(retired.offscreen_memory, m_offscreen_memory);
+	m_images.clear();
+	m_current_image = 0;
+
+	for (u32 i = 0; i < m_image_count; i++) {
+		auto& image = m_offscreen_images.emplace_back(
+			m_device.device(),
+			vk::ImageCreateInfo()
+				.setImageType(vk::ImageType::e2D)
+				.setFormat(m_format.format)
+				.setExtent({m_extent.width, m_extent.height, 1})
+				.setMipLevels(1)
+				.setArrayLayers(1)
+				.setSamples(vk::SampleCountFlagBits::e1)
+				.setTiling(vk::ImageTiling::eOptimal)
+				.setUsage(m_usage)
+				.setSharingMode(vk::SharingMode::eExclusive)
+				.setInitialLayout(vk::ImageLayout::eUndefined)
+		);
+		auto& memory = m_offscreen_memory.emplace_back(m_device.allocator().allocate(
+			image.getMemoryRequirements(),
+			vk::MemoryPropertyFlagBits::eDeviceLocal,
+			false
+		));
+		image.bindMemory(memory.memory(), memory.offset());
+	}
 
-	VX_DEBUG("Created swapchain ({}x{})", m_extent.width, m_extent.height);
+	VX_DEBUG("Created offscreen images ({}x{}, {} images)", m_extent.width, m_extent.height, m_image_count);
 }
 
 void Swapchain::create_image_views() {
-	m_images = m_swapchain.getImages();
-	m_image_views.clear();
+	if (headless()) {
+		m_images.clear();
+		for (const auto& image : m_offscreen_images) {
+			m_images.push_back(*image);
+		}
+	} else {
+		m_images = m_swapchain.getImages();
+	}
+	move_into(retire().image_views, m_image_views);
 	m_image_views.reserve(m_images.size());
+	m_generation++;
 
 	for (const auto& image : m_images) {
 		m_image_views.emplace_back(
@@ -131,29 +277,6 @@ void Swapchain::create_image_views() {
 	}
 }
 
-void Swapchain::create_framebuffers() {
-	if (!m_render_pass) {
-		return;
-	}
-
-	m_framebuffers.clear();
-	m_framebuffers.reserve(m_images.size());
-
-	for (const auto& view : m_image_views) {
-		std::array attachments = {*view};
-		m_framebuffers.emplace_back(
-			m_device.device(),
-			vk::FramebufferCreateInfo()
-				.setRenderPass(*m_render_pass)
-				.setAttachments(attachments)
-				.setWidth(m_extent.width)
-				.setHeight(m_extent.height)
-				.setLayers(1)
-
-		);
-	}
-}
-
 void Swapchain::choose_format(std::vector<vk::SurfaceFormatKHR>& formats) {
 	m_format = formats.front();
 	for (const auto& format : formats) {
@@ -164,18 +287,21 @@ void Swapchain::choose_format(std::vector<vk::SurfaceFormatKHR>& formats) {
 	}
 }
 
-void Swapchain::choose_present_mode(std::vector<vk::PresentModeKHR>& modes) {
+void Swapchain::choose_present_mode(const std::vector<vk::PresentModeKHR>& modes) {
+	// FIFO is the only mode every implementation has to support
 	m_present_mode = vk::PresentModeKHR::eFifo;
-	for (const auto& mode : modes) {
-		if (mode == vk::PresentModeKHR::eMailbox) {
-			m_present_mode = mode;
-			break;
-		}
+	if (std::ranges::find(modes, m_preferred_mode) != modes.end()) {
+		m_present_mode = m_preferred_mode;
+	} else {
+		VX_WARN("Present mode {} is not supported, using FIFO", vk::to_string(m_preferred_mode));
 	}
 }
 
 void Swapchain::choose_image_count(const vk::SurfaceCapabilitiesKHR& capabilities) {
-	m_image_count = capabilities.minImageCount + 1;
+	m_image_count = std::max(
+		m_preferred_image_count > 0 ? m_preferred_image_count : capabilities.minImageCount + 1,
+		capabilities.minImageCount
+	);
 	if (capabilities.maxImageCount > 0 && m_image_count > capabilities.maxImageCount) {
 		m_image_count = capabilities.maxImageCount;
 	}
@@ -184,7 +310,7 @@ void Swapchain::choose_image_count(const vk::SurfaceCapabilitiesKHR& capabilitie
 bool Swapchain::choose_extent(const vk::SurfaceCapabilitiesKHR& capabilities) {
 	const auto old = m_extent;
 	if (capabilities.currentExtent.width == std::numeric_limits<u32>::max()) {
-		const auto window_extent = m_window.extent();
+		const auto window_extent = m_window->extent();
 		m_extent.width =
 			std::clamp(window_extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
 		m_extent.height =
@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/gfx/device.h>
+#include <vulxels/gfx/timeline.h>
+
+#include <stdexcept>
+
+using namespace Vulxels::GFX;
+
+Timeline::Timeline(Device& device) : m_device(device) {
+	const vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> create(
+		vk::SemaphoreCreateInfo(),
+		vk::SemaphoreTypeCreateInfo().setSemaphoreType(vk::SemaphoreType::eTimeline).setInitialValue(0)
+	);
+	m_semaphore = vk::raii::Semaphore(m_device.device(), create.get<vk::SemaphoreCreateInfo>());
+}
+
+bool Timeline::wait(const u64 value, const u64 timeout) const {
+	const auto res = m_device.device().waitSemaphores(
+		vk::SemaphoreWaitInfo().setSemaphores(*m_semaphore).setValues(value),
+		timeout
+	);
+	if (res != vk::Result::eSuccess && res != vk::Result::eTimeout) {
+		throw std::runtime_error("Failed to wait for timeline semaphore");
+	}
+	return res == vk::Result::eTimeout;
+}
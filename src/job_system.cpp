@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifdef _WIN32
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+#include <vulxels/job_system.h>
+#include <vulxels/log.h>
+
+#include <algorithm>
+#include <exception>
+
+using namespace Vulxels;
+
+static constexpr usize NOT_A_WORKER = ~usize {0};
+
+// The system and worker the calling thread belongs to, if any
+static thread_local const JobSystem* t_system = nullptr;
+static thread_local usize t_worker = NOT_A_WORKER;
+
+static bool pin_to_core(const usize core) {
+#ifdef _WIN32
+	if (core >= sizeof(DWORD_PTR) * 8) {
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR {1} << core) != 0;
+#elif defined(__linux__)
+	if (core >= CPU_SETSIZE) {
+		return false;
+	}
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)core; // macOS only takes affinity hints
+	return false;
+#endif
+}
+
+JobSystem::JobSystem(const usize threads) {
+	m_workers.reserve(threads);
+	for (usize i = 0; i < threads; i++) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+	m_stats.resize(threads);
+	m_stats_busy.resize(threads);
+
+	// Only started once every worker exists, since they steal from each other
+	for (usize i = 0; i < threads; i++) {
+		m_workers[i]->thread = std::thread(&JobSystem::worker, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	shutdown();
+}
+
+void JobSystem::run(std::function<void()> func, const Priority priority, Counter* counter, Counter* after) {
+	if (counter) {
+		counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	Job job {std::move(func), priority, counter};
+	if (after) {
+		std::lock_guard lock(after->m_mutex);
+		if (!after->done()) {
+			after->m_held.push_back(std::move(job));
+			return;
+		}
+	}
+	enqueue(std::move(job));
+}
+
+void JobSystem::wait(Counter& counter, const Priority priority) {
+	VX_ZONE("JobSystem::wait");
+	const usize index = t_system == this ? t_worker : NOT_A_WORKER;
+	Job job;
+	while (!counter.done()) {
+		if (take(index, priority, job)) {
+			execute(index, job);
+			continue;
+		}
+		// Nothing to help with, the rest are running elsewhere or held back
+		std::unique_lock lock(counter.m_mutex);
+		counter.m_cv.wait_for(lock, std::chrono::milliseconds(1), [&] { return counter.done(); });
+	}
+
+	// The last job may still be notifying, the counter has to outlive that
+	std::lock_guard lock(counter.m_mutex);
+}
+
+void JobSystem::shutdown() {
+	{
+		std::lock_guard lock(m_sleep_mutex);
+		m_stopping = true;
+	}
+	m_sleep_cv.notify_all();
+	for (const auto& worker : m_workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+}
+
+std::vector<JobSystem::WorkerStats> JobSystem::stats() {
+	std::lock_guard lock(m_stats_mutex);
+	const auto now = Clock::now();
+	if (now - m_stats_time >= STATS_INTERVAL) {
+		// Jobs count when they finish, so one spanning intervals lands in the last
+		const f64 interval = std::chrono::duration<f64, std::nano>(now - m_stats_time).count();
+		for (usize i = 0; i < m_workers.size(); i++) {
+			const u64 busy = m_workers[i]->busy_ns.load(std::memory_order_relaxed);
+			const f64 utilisation = static_cast<f64>(busy - m_stats_busy[i]) / interval;
+			m_stats[i].utilisation = static_cast<f32>(std::min(utilisation, 1.0));
+			m_stats_busy[i] = busy;
+		}
+		m_stats_time = now;
+	}
+	for (usize i = 0; i < m_workers.size(); i++) {
+		m_stats[i].jobs = m_workers[i]->jobs.load(std::memory_order_relaxed);
+		m_stats[i].stolen = m_workers[i]->stolen.load(std::memory_order_relaxed);
+	}
+	return m_stats;
+}
+
+void JobSystem::worker(const usize index) {
+	VX_THREAD_NAME("Worker");
+	t_system = this;
+	t_worker = index;
+
+	// Core 0 is left to the main thread
+	const usize cores = std::thread::hardware_concurrency();
+	if (cores > 1 && !pin_to_core((index + 1) % cores)) {
+		VX_DEBUG("Worker {} could not be pinned to a core", index);
+	}
+
+	Job job;
+	while (true) {
+		if (take(index, Priority::Low, job)) {
+			execute(index, job);
+			continue;
+		}
+		std::unique_lock lock(m_sleep_mutex);
+		m_sleep_cv.wait(lock, [this] { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+		if (m_stopping && m_queued.load(std::memory_order_acquire) == 0) {
+			return;
+		}
+	}
+}
+
+void JobSystem::enqueue(Job&& job) {
+	// Workers keep the jobs they make, everyone else's are shared out
+	const usize index = t_system == this ? t_worker : m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+	{
+		auto& worker = *m_workers[index];
+		std::lock_guard lock(worker.mutex);
+		m_queued.fetch_add(1, std::memory_order_release);
+		worker.queues[static_cast<usize>(job.priority)].push_back(std::move(job));
+	}
+
+	// Taking the lock orders this with a worker about to sleep, so it can't miss the wake
+	{
+		std::lock_guard lock(m_sleep_mutex);
+	}
+	m_sleep_cv.notify_one();
+}
+
+bool JobSystem::take(const usize index, const Priority lowest, Job& job) {
+	if (m_queued.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	const usize count = m_workers.size();
+	for (usize priority = 0; priority <= static_cast<usize>(lowest); priority++) {
+		// The newest of our own, it's the most likely to still be in cache
+		if (index != NOT_A_WORKER) {
+			auto& own = *m_workers[index];
+			std::lock_guard lock(own.mutex);
+			auto& queue = own.queues[priority];
+			if (!queue.empty()) {
+				job = std::move(queue.back());
+				queue.pop_back();
+				m_queued.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		// Otherwise the oldest of someone else's, starting from the next worker along
+		const usize start = index == NOT_A_WORKER ? m_next.load(std::memory_order_relaxed) : index + 1;
+		for (usize i = 0; i < count; i++) {
+			const usize victim = (start + i) % count;
+			if (victim == index) {
+				continue;
+			}
+			auto& other = *m_workers[victim];
+			std::lock_guard lock(other.mutex);
+			auto& queue = other.queues[priority];
+			if (!queue.empty()) {
+				job = std::move(queue.front());
+				queue.pop_front();
+				m_queued.fetch_sub(1, std::memory_order_relaxed);
+				if (index != NOT_A_WORKER) {
+					m_workers[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+				}
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void JobSystem::execute(const usize index, Job& job) {
+	const auto start = Clock::now();
+	try {
+		job.func();
+	} catch (const std::exception& e) {
+		VX_ERROR("Job failed: {}", e.what());
+	} catch (...) {
+		// Swallowed either way, escaping a worker would terminate and skip finish()
+		VX_ERROR("Job failed: unknown exception");
+	}
+
+	if (index != NOT_A_WORKER) {
+		auto& worker = *m_workers[index];
+		const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+		worker.busy_ns.fetch_add(static_cast<u64>(busy), std::memory_order_relaxed);
+		worker.jobs.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (job.counter) {
+		finish(*job.counter);
+	}
+	// Captures are released now rather than whenever the next job replaces them
+	job = {};
+}
+
+void JobSystem::finish(Counter& counter) {
+	std::vector<Job> held;
+	{
+		std::lock_guard lock(counter.m_mutex);
+		if (counter.m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+		held.swap(counter.m_held);
+		counter.m_cv.notify_all();
+	}
+	// Nothing may touch the counter from here, a waiter is free to destroy it
+	for (auto& job : held) {
+		enqueue(std::move(job));
+	}
+}
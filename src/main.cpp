@@ -18,9 +18,32 @@
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
+#include <string_view>
+
+static void print_usage() {
+	std::puts(
+		"Usage: vulxels [options]\n"
+		"  --device <index|name>   Use this GPU instead of the best scoring one, by its index in the\n"
+		"                          device list logged at startup or part of its name"
+	);
+}
+
+int main(const int argc, char** argv) {
+	Vulxels::GFX::RendererConfig config;
+	for (int i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		if (arg == "--device" && i + 1 < argc) {
+			config.device = argv[++i];
+		} else if (arg == "--help" || arg == "-h") {
+			print_usage();
+			return EXIT_SUCCESS;
+		} else {
+			std::fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+			print_usage();
+			return EXIT_FAILURE;
+		}
+	}
 
-int main(int, char** argv) {
-	// TODO: Parse command line arguments
 	std::filesystem::current_path(std::filesystem::path(argv[0]).parent_path());
 
 #ifdef _WIN32
@@ -30,6 +53,7 @@ int main(int, char** argv) {
 	}
 #endif
 
+	VX_THREAD_NAME("Main");
 	VX_LOG("Vulxels v{}.{}.{}", VX_VERSION_MAJOR, VX_VERSION_MINOR, VX_VERSION_PATCH);
 #ifndef NDEBUG
 	VX_WARN("Running in debug mode");
@@ -37,7 +61,7 @@ int main(int, char** argv) {
 #endif
 
 	try {
-		Vulxels::App app;
+		Vulxels::App app(config);
 		app.run();
 	} catch (const std::exception& e) {
 		VX_CRIT("Unhandled exception: {}", e.what());
@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/log.h>
+#include <vulxels/profiler.h>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace Vulxels;
+
+namespace {
+	struct Event {
+		const char* name;
+		u64 start;
+		u64 end;
+	};
+
+	// Single producer (the owning thread), single consumer (Profiler::frame)
+	struct ThreadBuffer {
+		static constexpr u64 CAPACITY = 1 << 14;
+
+		std::array<Event, CAPACITY> events;
+		std::atomic<u64> head {0};
+		std::atomic<u64> tail {0};
+		std::atomic<u64> dropped {0};
+		u32 id = 0;
+		std::string name;
+
+		void push(const Event& event) {
+			const u64 h = head.load(std::memory_order_relaxed);
+			if (h - tail.load(std::memory_order_acquire) == CAPACITY) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			events[h & (CAPACITY - 1)] = event;
+			head.store(h + 1, std::memory_order_release);
+		}
+
+		template<typename F>
+		void drain(F&& func) {
+			const u64 t = tail.load(std::memory_order_relaxed);
+			const u64 h = head.load(std::memory_order_acquire);
+			for (u64 i = t; i < h; i++) {
+				func(events[i & (CAPACITY - 1)]);
+			}
+			tail.store(h, std::memory_order_release);
+		}
+	};
+
+	struct CapturedEvent {
+		u32 thread;
+		Event event;
+	};
+
+	struct State {
+		std::mutex mutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> threads;
+		std::vector<CapturedEvent> captured;
+		std::string path;
+		u32 frames_left = 0;
+	};
+
+	State& state() {
+		static State state;
+		return state;
+	}
+
+	ThreadBuffer& thread_buffer() {
+		// Shared with the registry so a capture can still read it after the thread exits
+		thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+			auto& s = state();
+			std::lock_guard lock(s.mutex);
+			auto result = std::make_shared<ThreadBuffer>();
+			result->id = static_cast<u32>(s.threads.size());
+			result->name = result->id == 0 ? "Main" : "Thread " + std::to_string(result->id);
+			s.threads.push_back(result);
+			return result;
+		}();
+		return *buffer;
+	}
+
+	void collect(State& s) {
+		for (const auto& thread : s.threads) {
+			thread->drain([&](const Event& event) { s.captured.push_back({thread->id, event}); });
+		}
+	}
+
+	// Names are arbitrary strings, quotes, backslashes and control characters
+	// would otherwise end up in the trace as invalid JSON
+	std::string escape_json(const std::string_view text) {
+		std::string escaped;
+		escaped.reserve(text.size());
+		for (const char c : text) {
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+				escaped += c;
+			} else if (static_cast<unsigned char>(c) < 0x20) {
+				escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+			} else {
+				escaped += c;
+			}
+		}
+		return escaped;
+	}
+
+	void write_trace(const State& s) {
+		std::ofstream file(s.path, std::ios::trunc);
+		if (!file.is_open()) {
+			VX_ERROR("Failed to open trace file: \"{}\"", s.path);
+			return;
+		}
+
+		u64 dropped = 0;
+		const char* separator = "";
+		file << "{\"traceEvents\":[";
+		for (const auto& thread : s.threads) {
+			dropped += thread->dropped.exchange(0, std::memory_order_relaxed);
+			file << std::exchange(separator, ",") << '\n'
+				 << fmt::format(
+						R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"{}"}}}})",
+						thread->id,
+						escape_json(thread->name)
+					);
+		}
+		for (const auto& [thread, event] : s.captured) {
+			file << std::exchange(separator, ",") << '\n'
+				 << fmt::format(
+						R"({{"name":"{}","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+						escape_json(event.name),
+						thread,
+						static_cast<f64>(event.start) / 1000.0,
+						static_cast<f64>(event.end - event.start) / 1000.0
+					);
+		}
+		file << "\n]}\n";
+
+		VX_LOG("Wrote CPU trace with {} zones: \"{}\"", s.captured.size(), s.path);
+		if (dropped > 0) {
+			VX_WARN("{} zones were dropped because a thread's ring was full", dropped);
+		}
+	}
+} // namespace
+
+void Profiler::capture(const u32 frames, std::string path) {
+	auto& s = state();
+	std::lock_guard lock(s.mutex);
+	if (s_active.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	// Throw away anything left over from the end of the last capture
+	for (const auto& thread : s.threads) {
+		thread->drain([](const Event&) {});
+		thread->dropped.store(0, std::memory_order_relaxed);
+	}
+	s.captured.clear();
+	s.path = std::move(path);
+	s.frames_left = frames;
+	s_active.store(true, std::memory_order_relaxed);
+
+	VX_LOG("Capturing CPU trace for {} frames", frames);
+}
+
+void Profiler::frame() {
+	if (!s_active.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	auto& s = state();
+	std::lock_guard lock(s.mutex);
+	if (s.frames_left > 0 && --s.frames_left > 0) {
+		collect(s);
+		return;
+	}
+
+	s_active.store(false, std::memory_order_relaxed);
+	collect(s);
+	write_trace(s);
+	s.captured.clear();
+}
+
+void Profiler::set_thread_name(const std::string_view name) {
+	auto& buffer = thread_buffer();
+	std::lock_guard lock(state().mutex);
+	buffer.name = name;
+}
+
+u64 Profiler::now() {
+	static const auto epoch = std::chrono::steady_clock::now();
+	return static_cast<u64>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count()
+	);
+}
+
+void Profiler::record(const char* name, const u64 start, const u64 end) {
+	thread_buffer().push({name, start, end});
+}
@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/log.h>
+#include <vulxels/world/chunk.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+using namespace Vulxels::World;
+
+// Narrowest supported width that can index `entries` palette entries
+static u32 bits_for(const usize entries) {
+	if (entries <= 1) {
+		return 0;
+	}
+	u32 bits = 1;
+	while ((usize(1) << bits) < entries) {
+		bits *= 2;
+	}
+	return bits;
+}
+
+static usize words_for(const u32 bits) {
+	return std::max<usize>(1, usize(Chunk::VOLUME) * bits / 64);
+}
+
+Chunk::Chunk(const BlockId fill) {
+	this->fill(fill);
+}
+
+void Chunk::set(const u32 index, const BlockId block) {
+	const u32 old = raw(index);
+	if (m_palette[old] == block) {
+		return;
+	}
+	// Widening keeps entry numbers, so `old` is still valid afterwards
+	const u32 entry = entry_for(block);
+	write(index, entry);
+	m_counts[entry]++;
+	release(old, 1);
+}
+
+void Chunk::fill(const BlockId block) {
+	// Assigned fresh rather than cleared so the old capacity is given back
+	m_palette = {block};
+	m_counts = {VOLUME};
+	m_data = std::vector<u64>(1, 0);
+	m_bits = 0;
+	m_mask = 0;
+	m_live = 1;
+}
+
+void Chunk::fill(const glm::uvec3 min, const glm::uvec3 max, const BlockId block) {
+	const auto lo = glm::min(min, glm::uvec3(SIZE));
+	const auto hi = glm::min(max, glm::uvec3(SIZE));
+	if (glm::any(glm::greaterThanEqual(lo, hi))) {
+		return;
+	}
+	if (lo == glm::uvec3(0) && hi == glm::uvec3(SIZE)) {
+		fill(block);
+		return;
+	}
+
+	const u32 entry = entry_for(block);
+	for (u32 y = lo.y; y < hi.y; y++) {
+		for (u32 z = lo.z; z < hi.z; z++) {
+			for (u32 x = lo.x; x < hi.x; x++) {
+				const u32 i = index(x, y, z);
+				const u32 old = raw(i);
+				m_counts[old]--;
+				write(i, entry);
+			}
+		}
+	}
+	m_counts[entry] += (hi.x - lo.x) * (hi.y - lo.y) * (hi.z - lo.z);
+
+	m_live = static_cast<u32>(std::ranges::count_if(m_counts, [](const u32 count) { return count > 0; }));
+	if (m_live == 1 || bits_for(m_live * 2) < m_bits) {
+		repack(bits_for(m_live), true);
+	}
+}
+
+void Chunk::copy_from(const std::span<const BlockId> blocks) {
+	VX_ZONE("Chunk::copy_from");
+	if (blocks.size() != VOLUME) {
+		throw std::invalid_argument("Chunk::copy_from needs exactly one chunk of blocks");
+	}
+
+	// Generated terrain comes in long runs, so the previous block's entry is
+	// checked before scanning the palette
+	std::vector<BlockId> palette;
+	std::vector<u32> counts;
+	std::vector<u16> entries(VOLUME);
+	u32 last = 0;
+	for (u32 i = 0; i < VOLUME; i++) {
+		if (palette.empty() || palette[last] != blocks[i]) {
+			const auto it = std::ranges::find(palette, blocks[i]);
+			last = static_cast<u32>(it - palette.begin());
+			if (it == palette.end()) {
+				palette.push_back(blocks[i]);
+				counts.push_back(0);
+			}
+		}
+		counts[last]++;
+		entries[i] = static_cast<u16>(last);
+	}
+
+	if (palette.size() == 1) {
+		fill(palette.front());
+		return;
+	}
+
+	m_bits = bits_for(palette.size());
+	m_mask = (u64(1) << m_bits) - 1;
+	m_data.assign(words_for(m_bits), 0);
+	for (u32 i = 0; i < VOLUME; i++) {
+		const u32 bit = i * m_bits;
+		m_data[bit >> 6] |= u64(entries[i]) << (bit & 63);
+	}
+	m_palette = std::move(palette);
+	m_counts = std::move(counts);
+	m_live = static_cast<u32>(m_palette.size());
+}
+
+void Chunk::copy_to(const std::span<BlockId> blocks) const {
+	if (blocks.size() != VOLUME) {
+		throw std::invalid_argument("Chunk::copy_to needs room for exactly one chunk of blocks");
+	}
+	if (uniform()) {
+		std::ranges::fill(blocks, m_palette.front());
+		return;
+	}
+
+	// A word at a time rather than through get(), meshing starts with this
+	const u32 per_word = 64 / m_bits;
+	for (usize word = 0; word < m_data.size(); word++) {
+		u64 bits = m_data[word];
+		BlockId* out = &blocks[word * per_word];
+		for (u32 i = 0; i < per_word; i++) {
+			out[i] = m_palette[bits & m_mask];
+			bits >>= m_bits;
+		}
+	}
+}
+
+usize Chunk::memory_usage() const {
+	return sizeof(Chunk) + m_palette.capacity() * sizeof(BlockId) + m_counts.capacity() * sizeof(u32)
+		+ m_data.capacity() * sizeof(u64);
+}
+
+u32 Chunk::entry_for(const BlockId block) {
+	// Palettes are short and never hold an id twice, so a scan beats hashing
+	if (const auto it = std::ranges::find(m_palette, block); it != m_palette.end()) {
+		const auto entry = static_cast<u32>(it - m_palette.begin());
+		if (m_counts[entry] == 0) {
+			m_live++;
+		}
+		return entry;
+	}
+
+	m_live++;
+	if (const auto it = std::ranges::find(m_counts, 0u); it != m_counts.end()) {
+		const auto entry = static_cast<u32>(it - m_counts.begin());
+		m_palette[entry] = block;
+		return entry;
+	}
+
+	m_palette.push_back(block);
+	m_counts.push_back(0);
+	if (m_palette.size() > (usize(1) << m_bits)) {
+		repack(bits_for(m_palette.size()), false);
+	}
+	return static_cast<u32>(m_palette.size() - 1);
+}
+
+void Chunk::release(const u32 entry, const u32 count) {
+	m_counts[entry] -= count;
+	if (m_counts[entry] > 0) {
+		return;
+	}
+	m_live--;
+
+	// Only narrow once what's left fits in half the narrower width, so a chunk
+	// hovering around a boundary doesn't repack on every change
+	if (m_live == 1 || bits_for(m_live * 2) < m_bits) {
+		repack(bits_for(m_live), true);
+	}
+}
+
+void Chunk::repack(const u32 bits, const bool compact) {
+	VX_ZONE("Chunk::repack");
+
+	// Entries keep their numbers when widening, narrowing drops the free ones
+	std::vector<u32> remap(m_palette.size());
+	std::vector<BlockId> palette;
+	std::vector<u32> counts;
+	if (compact) {
+		for (u32 i = 0; i < m_palette.size(); i++) {
+			if (m_counts[i] > 0) {
+				remap[i] = static_cast<u32>(palette.size());
+				palette.push_back(m_palette[i]);
+				counts.push_back(m_counts[i]);
+			}
+		}
+	} else {
+		std::iota(remap.begin(), remap.end(), 0u);
+		palette = std::move(m_palette);
+		counts = std::move(m_counts);
+	}
+
+	std::vector<u64> data(words_for(bits), 0);
+	if (bits > 0) {
+		for (u32 i = 0; i < VOLUME; i++) {
+			const u32 bit = i * bits;
+			data[bit >> 6] |= u64(remap[raw(i)]) << (bit & 63);
+		}
+	}
+
+	m_palette = std::move(palette);
+	m_counts = std::move(counts);
+	m_data = std::move(data);
+	m_bits = bits;
+	m_mask = bits == 0 ? 0 : (u64(1) << bits) - 1;
+}
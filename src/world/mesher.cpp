@@ -0,0 +1,276 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/log.h>
+#include <vulxels/world/chunk_map.h>
+#include <vulxels/world/mesher.h>
+
+#include <algorithm>
+#include <bit>
+
+using namespace Vulxels::World;
+
+// Columns and layers along each axis are addressed by (u, v) across them:
+// along x, u is y and v is z; along y, u is z and v is x; along z, u is y and v is x
+static glm::uvec3 to_block(const u32 axis, const u32 d, const u32 u, const u32 v) {
+	switch (axis) {
+		case 0: return {d, u, v};
+		case 1: return {v, d, u};
+		default: return {v, u, d};
+	}
+}
+
+// The u and v axes across the faces of each axis
+static constexpr std::array<std::array<u32, 2>, 3> TANGENTS = {{{1, 2}, {2, 0}, {1, 0}}};
+
+// The occlusion of a face's corners from the 3×3 blocks around the empty one
+// in front of it, bit (u + 1) + (v + 1) * 3. Each corner is darker for each of
+// the three blocks beside and diagonal to it, or fully dark when wedged
+// between both sides.
+static constexpr std::array<u8, 512> OCCLUSION = [] {
+	constexpr std::array<std::array<i32, 2>, 4> CORNERS = {{{-1, -1}, {1, -1}, {1, 1}, {-1, 1}}};
+	std::array<u8, 512> table {};
+	for (u32 around = 0; around < 512; around++) {
+		const auto solid = [&](const i32 du, const i32 dv) {
+			return (around >> ((du + 1) + (dv + 1) * 3)) & 1;
+		};
+		for (u32 corner = 0; corner < 4; corner++) {
+			const auto [du, dv] = CORNERS[corner];
+			const u32 side_u = solid(du, 0);
+			const u32 side_v = solid(0, dv);
+			const u32 value = side_u && side_v ? 0 : 3 - (side_u + side_v + solid(du, dv));
+			table[around] |= static_cast<u8>(value << (corner * 2));
+		}
+	}
+	return table;
+}();
+
+// Bit j of row i swaps with bit i of row j, swapping ever smaller blocks of bits
+static void transpose(std::array<u32, Chunk::SIZE>& rows) {
+	u32 mask = 0x0000ffff;
+	for (u32 j = 16; j != 0; j >>= 1, mask ^= mask << j) {
+		for (u32 k = 0; k < Chunk::SIZE; k = (k + j + 1) & ~j) {
+			const u32 t = ((rows[k] >> j) ^ rows[k + j]) & mask;
+			rows[k] ^= t << j;
+			rows[k + j] ^= t;
+		}
+	}
+}
+
+void Mesher::mesh(const Chunk& chunk, const Neighbours& neighbours, std::vector<ChunkQuad>& quads) {
+	VX_ZONE("Mesher::mesh");
+	quads.clear();
+	if (chunk.uniform() && chunk.get(0) == Block::Air) {
+		return;
+	}
+
+	chunk.copy_to(m_blocks);
+	build_columns(neighbours);
+	for (u8 face = 0; face < 6; face++) {
+		mesh_face(static_cast<Face>(face), quads);
+	}
+}
+
+std::vector<u32> Mesher::quad_indices(const u32 quads) {
+	std::vector<u32> indices;
+	indices.reserve(static_cast<usize>(quads) * 6);
+	for (u32 quad = 0; quad < quads; quad++) {
+		const u32 base = quad * 4;
+		indices.insert(indices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+	}
+	return indices;
+}
+
+void Mesher::build_columns(const Neighbours& neighbours) {
+	// This chunk's rows along x, straight from the blocks
+	std::array<std::array<u32, SIZE>, SIZE> rows; // [y][z], bit x
+	for (u32 y = 0; y < SIZE; y++) {
+		for (u32 z = 0; z < SIZE; z++) {
+			const BlockId* row = &m_blocks[Chunk::index(0, y, z)];
+			u32 bits = 0;
+			for (u32 x = 0; x < SIZE; x++) {
+				bits |= static_cast<u32>(row[x] != Block::Air) << x;
+			}
+			rows[y][z] = bits;
+		}
+	}
+
+	m_padded.fill(0);
+	for (u32 y = 0; y < SIZE; y++) {
+		for (u32 z = 0; z < SIZE; z++) {
+			m_padded[(y + 1) * PADDED + (z + 1)] = static_cast<u64>(rows[y][z]) << 1;
+		}
+	}
+
+	// Then the layer of blocks around it, from all 26 neighbours
+	const auto range = [](const i32 d) {
+		return d < 0 ? std::pair(SIZE - 1, SIZE) : d > 0 ? std::pair(0u, 1u) : std::pair(0u, SIZE);
+	};
+	const auto padded = [](const i32 d, const u32 i) {
+		return d < 0 ? 0 : d > 0 ? PADDED - 1 : i + 1;
+	};
+	for (i32 dy = -1; dy <= 1; dy++) {
+		for (i32 dz = -1; dz <= 1; dz++) {
+			for (i32 dx = -1; dx <= 1; dx++) {
+				const Chunk* neighbour = neighbours[ChunkMap<Chunk>::neighbour_index(dx, dy, dz)];
+				if ((dx == 0 && dy == 0 && dz == 0) || neighbour == nullptr
+					|| (neighbour->uniform() && neighbour->get(0) == Block::Air)) {
+					continue;
+				}
+				const auto [x0, x1] = range(dx);
+				const auto [y0, y1] = range(dy);
+				const auto [z0, z1] = range(dz);
+				for (u32 y = y0; y < y1; y++) {
+					for (u32 z = z0; z < z1; z++) {
+						u64 bits = 0;
+						for (u32 x = x0; x < x1; x++) {
+							bits |= static_cast<u64>(neighbour->get(x, y, z) != Block::Air) << padded(dx, x);
+						}
+						m_padded[padded(dy, y) * PADDED + padded(dz, z)] |= bits;
+					}
+				}
+			}
+		}
+	}
+
+	// Columns along x are the padded rows as they are, the other two axes are
+	// the same bits transposed a 32×32 slice at a time with their ends from the
+	// padding
+	auto& along_x = m_columns[0];
+	auto& along_y = m_columns[1];
+	auto& along_z = m_columns[2];
+	for (u32 y = 0; y < SIZE; y++) {
+		for (u32 z = 0; z < SIZE; z++) {
+			along_x[y * SIZE + z] = m_padded[(y + 1) * PADDED + (z + 1)];
+		}
+	}
+
+	std::array<u32, SIZE> slice;
+	for (u32 y = 0; y < SIZE; y++) {
+		slice = rows[y];
+		transpose(slice);
+		const u64 below = m_padded[(y + 1) * PADDED];
+		const u64 above = m_padded[(y + 1) * PADDED + PADDED - 1];
+		for (u32 x = 0; x < SIZE; x++) {
+			along_z[y * SIZE + x] =
+				(static_cast<u64>(slice[x]) << 1) | ((below >> (x + 1)) & 1) | (((above >> (x + 1)) & 1) << (SIZE + 1));
+		}
+	}
+	for (u32 z = 0; z < SIZE; z++) {
+		for (u32 y = 0; y < SIZE; y++) {
+			slice[y] = rows[y][z];
+		}
+		transpose(slice);
+		const u64 below = m_padded[z + 1];
+		const u64 above = m_padded[(PADDED - 1) * PADDED + (z + 1)];
+		for (u32 x = 0; x < SIZE; x++) {
+			along_y[z * SIZE + x] =
+				(static_cast<u64>(slice[x]) << 1) | ((below >> (x + 1)) & 1) | (((above >> (x + 1)) & 1) << (SIZE + 1));
+		}
+	}
+}
+
+void Mesher::mesh_face(const Face face, std::vector<ChunkQuad>& quads) {
+	const u32 axis = static_cast<u32>(face) / 2;
+	const bool negative = static_cast<u32>(face) & 1;
+
+	// A block's face shows when the next block along is empty
+	u32 used = 0;
+	for (auto& layer : m_layers) {
+		layer.fill(0);
+	}
+	const auto& columns = m_columns[axis];
+	for (u32 i = 0; i < SIZE * SIZE; i++) {
+		const u64 column = columns[i];
+		const u64 visible = negative ? column & ~(column << 1) : column & ~(column >> 1);
+		u32 faces = static_cast<u32>(visible >> 1);
+		const u32 u = i / SIZE;
+		const u32 row_bit = 1u << (i % SIZE);
+		used |= faces;
+		for (; faces != 0; faces &= faces - 1) {
+			m_layers[std::countr_zero(faces)][u] |= row_bit;
+		}
+	}
+
+	for (; used != 0; used &= used - 1) {
+		const u32 d = static_cast<u32>(std::countr_zero(used));
+
+		// Split the layer by block and occlusion, there are rarely more than a few
+		m_planes.clear();
+		usize last = 0;
+		for (u32 u = 0; u < SIZE; u++) {
+			for (u32 bits = m_layers[d][u]; bits != 0; bits &= bits - 1) {
+				const u32 v = static_cast<u32>(std::countr_zero(bits));
+				const auto at = to_block(axis, d, u, v);
+				const BlockId block = m_blocks[Chunk::index(at.x, at.y, at.z)];
+				const u8 ao = occlusion(face, at);
+				if (m_planes.empty() || m_planes[last].block != block || m_planes[last].ao != ao) {
+					const auto it = std::ranges::find_if(m_planes, [&](const Plane& plane) {
+						return plane.block == block && plane.ao == ao;
+					});
+					if (it == m_planes.end()) {
+						m_planes.push_back({block, ao, {}});
+						last = m_planes.size() - 1;
+					} else {
+						last = static_cast<usize>(it - m_planes.begin());
+					}
+				}
+				m_planes[last].rows[u] |= 1u << v;
+			}
+		}
+
+		for (auto& plane : m_planes) {
+			merge(face, d, plane, quads);
+		}
+	}
+}
+
+u8 Mesher::occlusion(const Face face, const glm::uvec3 block) const {
+	const u32 axis = static_cast<u32>(face) / 2;
+	const auto [tu, tv] = TANGENTS[axis];
+	std::array<i32, 3> front = {static_cast<i32>(block.x), static_cast<i32>(block.y), static_cast<i32>(block.z)};
+	front[axis] += static_cast<u32>(face) & 1 ? -1 : 1;
+
+	// Stepping along x moves a bit in the padded rows, along y or z a whole row
+	static constexpr std::array<i32, 3> ROW_STEP = {0, PADDED, 1};
+	static constexpr std::array<i32, 3> BIT_STEP = {1, 0, 0};
+	const i32 row = (front[1] + 1) * static_cast<i32>(PADDED) + front[2] + 1;
+	const i32 bit = front[0] + 1;
+
+	u32 around = 0;
+	for (i32 dv = -1; dv <= 1; dv++) {
+		for (i32 du = -1; du <= 1; du++) {
+			const i32 r = row + du * ROW_STEP[tu] + dv * ROW_STEP[tv];
+			const i32 b = bit + du * BIT_STEP[tu] + dv * BIT_STEP[tv];
+			around |= static_cast<u32>((m_padded[r] >> b) & 1) << ((du + 1) + (dv + 1) * 3);
+		}
+	}
+	return OCCLUSION[around];
+}
+
+void Mesher::merge(const Face face, const u32 layer, Plane& plane, std::vector<ChunkQuad>& quads) const {
+	const u32 axis = static_cast<u32>(face) / 2;
+	const u32 d = static_cast<u32>(face) & 1 ? layer : layer + 1;
+
+	auto& rows = plane.rows;
+	for (u32 u = 0; u < SIZE; u++) {
+		while (rows[u] != 0) {
+			// The lowest run of bits in the row, then as many rows after it as
+			// have the whole run set
+			const u32 v = static_cast<u32>(std::countr_zero(rows[u]));
+			const u32 height = static_cast<u32>(std::countr_zero(~(rows[u] >> v)));
+			const u32 run = height == SIZE ? ~0u : ((1u << height) - 1) << v;
+			u32 width = 1;
+			while (u + width < SIZE && (rows[u + width] & run) == run) {
+				rows[u + width] &= ~run;
+				width++;
+			}
+			rows[u] &= ~run;
+
+			quads.push_back(ChunkQuad::pack(to_block(axis, d, u, v), width, height, face, plane.block, plane.ao));
+		}
+	}
+}
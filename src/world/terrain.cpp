@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2025, Jayden Grubb <contact@jaydengrubb.com>
+ * 
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <vulxels/log.h>
+#include <vulxels/world/terrain.h>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+
+using namespace Vulxels::World;
+
+static constexpr f32 HEIGHT_SCALE = 64.0f;
+static constexpr i32 SNOW_LINE = 36;
+static constexpr i32 BEACH_HEIGHT = 2;
+static constexpr i32 DIRT_DEPTH = 3;
+static constexpr f32 CAVE_THRESHOLD = 0.78f;
+
+static f32 smooth(const f32 t) {
+	return t * t * (3.0f - 2.0f * t);
+}
+
+TerrainGenerator::TerrainGenerator(const u64 seed) : m_seed(seed) {}
+
+void TerrainGenerator::generate(const glm::ivec3 chunk_coord, Chunk& chunk) const {
+	VX_ZONE("TerrainGenerator::generate");
+	const auto origin = chunk_coord * static_cast<i32>(Chunk::SIZE);
+
+	std::array<i32, Chunk::AREA> heights;
+	i32 highest = INT_MIN;
+	for (u32 z = 0; z < Chunk::SIZE; z++) {
+		for (u32 x = 0; x < Chunk::SIZE; x++) {
+			const i32 h = height(origin.x + static_cast<i32>(x), origin.z + static_cast<i32>(z));
+			heights[z * Chunk::SIZE + x] = h;
+			highest = std::max(highest, h);
+		}
+	}
+
+	// Most chunks are entirely above the surface and the sea
+	if (origin.y > highest && origin.y > SEA_LEVEL) {
+		chunk.fill(Block::Air);
+		return;
+	}
+
+	std::array<BlockId, Chunk::VOLUME> blocks;
+	for (u32 y = 0; y < Chunk::SIZE; y++) {
+		const i32 wy = origin.y + static_cast<i32>(y);
+		for (u32 z = 0; z < Chunk::SIZE; z++) {
+			const i32 wz = origin.z + static_cast<i32>(z);
+			for (u32 x = 0; x < Chunk::SIZE; x++) {
+				const i32 wx = origin.x + static_cast<i32>(x);
+				const i32 h = heights[z * Chunk::SIZE + x];
+
+				BlockId block = Block::Air;
+				if (wy > h) {
+					block = wy <= SEA_LEVEL ? Block::Water : Block::Air;
+				} else if (wy < h - DIRT_DEPTH) {
+					block = Block::Stone;
+				} else if (h <= SEA_LEVEL + BEACH_HEIGHT) {
+					block = Block::Sand;
+				} else if (wy == h) {
+					block = h >= SNOW_LINE ? Block::Snow : Block::Grass;
+				} else {
+					block = Block::Dirt;
+				}
+
+				// Kept a block under the surface so caves never hole the ground
+				if (block != Block::Air && block != Block::Water && wy < h - 1
+					&& noise(wx, wy, wz, 1.0f / 24.0f) > CAVE_THRESHOLD) {
+					block = Block::Air;
+				}
+				blocks[Chunk::index(x, y, z)] = block;
+			}
+		}
+	}
+	chunk.copy_from(blocks);
+}
+
+i32 TerrainGenerator::height(const i32 x, const i32 z) const {
+	// A few octaves of value noise, shaped so low ground is flatter than peaks
+	f32 sum = 0.0f;
+	f32 amplitude = 0.5f;
+	f32 frequency = 1.0f / 128.0f;
+	for (u32 octave = 0; octave < 5; octave++) {
+		sum += noise(x, z, frequency) * amplitude;
+		amplitude *= 0.5f;
+		frequency *= 2.0f;
+	}
+	const f32 shaped = sum * sum * 1.6f - 0.25f;
+	return static_cast<i32>(std::floor(shaped * HEIGHT_SCALE));
+}
+
+f32 TerrainGenerator::noise(const i32 x, const i32 z, const f32 frequency) const {
+	const f32 fx = static_cast<f32>(x) * frequency;
+	const f32 fz = static_cast<f32>(z) * frequency;
+	const auto x0 = static_cast<i64>(std::floor(fx));
+	const auto z0 = static_cast<i64>(std::floor(fz));
+	const f32 tx = smooth(fx - static_cast<f32>(x0));
+	const f32 tz = smooth(fz - static_cast<f32>(z0));
+
+	const f32 a = std::lerp(lattice(x0, 0, z0), lattice(x0 + 1, 0, z0), tx);
+	const f32 b = std::lerp(lattice(x0, 0, z0 + 1), lattice(x0 + 1, 0, z0 + 1), tx);
+	return std::lerp(a, b, tz);
+}
+
+f32 TerrainGenerator::noise(const i32 x, const i32 y, const i32 z, const f32 frequency) const {
+	const f32 fx = static_cast<f32>(x) * frequency;
+	const f32 fy = static_cast<f32>(y) * frequency;
+	const f32 fz = static_cast<f32>(z) * frequency;
+	const auto x0 = static_cast<i64>(std::floor(fx));
+	const auto y0 = static_cast<i64>(std::floor(fy));
+	const auto z0 = static_cast<i64>(std::floor(fz));
+	const f32 tx = smooth(fx - static_cast<f32>(x0));
+	const f32 ty = smooth(fy - static_cast<f32>(y0));
+	const f32 tz = smooth(fz - static_cast<f32>(z0));
+
+	f32 layers[2];
+	for (i64 dy = 0; dy < 2; dy++) {
+		const f32 a = std::lerp(lattice(x0, y0 + dy, z0), lattice(x0 + 1, y0 + dy, z0), tx);
+		const f32 b = std::lerp(lattice(x0, y0 + dy, z0 + 1), lattice(x0 + 1, y0 + dy, z0 + 1), tx);
+		layers[dy] = std::lerp(a, b, tz);
+	}
+	return std::lerp(layers[0], layers[1], ty);
+}
+
+f32 TerrainGenerator::lattice(const i64 x, const i64 y, const i64 z) const {
+	// SplitMix64 finaliser over the combined coordinates
+	u64 h = m_seed ^ (static_cast<u64>(x) * 0x9e3779b97f4a7c15) ^ (static_cast<u64>(y) * 0xc2b2ae3d27d4eb4f)
+		^ (static_cast<u64>(z) * 0x165667b19e3779f9);
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+	h ^= h >> 31;
+	return static_cast<f32>(h >> 40) / static_cast<f32>(1 << 24);
+}